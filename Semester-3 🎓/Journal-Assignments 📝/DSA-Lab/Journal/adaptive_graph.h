@@ -0,0 +1,312 @@
+#ifndef DSA_ADAPTIVE_GRAPH_H
+#define DSA_ADAPTIVE_GRAPH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include "graph_file.h"
+#include "parallel.h"
+using namespace std;
+
+// One graph, stored either as a dense matrix or as sparse CSR, whichever
+// suits its density, with parallel conversion between the two.
+//
+//  - DenseGraph: one bit row per vertex (bit v of row u set for u -> v)
+//    plus, for weighted graphs, a full weight matrix. Edge tests are one
+//    bit lookup and neighbour scans walk 64 vertices per word.
+//  - SparseGraph: CSR arrays (see graph_file.h), owned or borrowed from a
+//    GraphStore or a mapped file. Memory grows with the edges only.
+//
+// Both offer the same small interface (numVertices, degree, hasEdge,
+// weight, forEachNeighbor), so an algorithm written as a template runs on
+// either; AdaptiveGraph::dispatch() calls it with the representation
+// actually held, and kernels that gain from a layout (the bitset BFS
+// below) are plain overloads picked at compile time.
+
+class SparseGraph;
+
+class DenseGraph {
+private:
+    uint64_t n = 0;
+    uint64_t words = 0;         // 64-bit words per row
+    vector<uint64_t> bits;      // n rows of `words` words
+    vector<int32_t> weights;    // n x n, empty for unweighted graphs
+
+public:
+    DenseGraph() {}
+
+    // Parallel conversion from CSR, one band of rows per thread. Repeated
+    // edges keep the weight of the last one.
+    static DenseGraph fromCsr(const CsrView& g, unsigned numThreads = defaultThreadCount()) {
+        DenseGraph d;
+        d.n = g.numVertices;
+        d.words = (d.n + 63) / 64;
+        d.bits.assign(d.n * d.words, 0);
+        if (g.weights) d.weights.assign(d.n * d.n, 0);
+        parallelForChunks(d.n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+            for (uint64_t u = begin; u < end; u++) {
+                uint64_t* row = d.bits.data() + u * d.words;
+                for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                    uint32_t v = g.targets[e];
+                    row[v / 64] |= 1ULL << (v % 64);
+                    if (g.weights) d.weights[u * d.n + v] = g.weights[e];
+                }
+            }
+        });
+        return d;
+    }
+
+    uint64_t numVertices() const { return n; }
+    bool isWeighted() const { return !weights.empty(); }
+    const uint64_t* row(uint32_t u) const { return bits.data() + u * words; }
+    uint64_t rowWords() const { return words; }
+
+    bool hasEdge(uint32_t u, uint32_t v) const { return (row(u)[v / 64] >> (v % 64)) & 1; }
+    int weight(uint32_t u, uint32_t v) const {
+        if (!hasEdge(u, v)) return 0;
+        return weights.empty() ? 1 : weights[u * n + v];
+    }
+
+    uint32_t degree(uint32_t u) const {
+        uint32_t count = 0;
+        for (uint64_t x = 0; x < words; x++) count += __builtin_popcountll(row(u)[x]);
+        return count;
+    }
+
+    // f(v, weight) for every v with u -> v, in increasing order of v
+    template <class F>
+    void forEachNeighbor(uint32_t u, F f) const {
+        const uint64_t* r = row(u);
+        for (uint64_t x = 0; x < words; x++) {
+            for (uint64_t m = r[x]; m; m &= m - 1) {
+                uint32_t v = (uint32_t)(x * 64 + __builtin_ctzll(m));
+                f(v, weights.empty() ? 1 : weights[u * n + v]);
+            }
+        }
+    }
+
+    static uint64_t bytesFor(uint64_t n, bool weighted) {
+        return n * ((n + 63) / 64) * 8 + (weighted ? n * n * 4 : 0);
+    }
+
+    SparseGraph toSparse(unsigned numThreads = defaultThreadCount()) const;
+};
+
+class SparseGraph {
+private:
+    CsrView view;
+    vector<uint64_t> offsets;  // used when the arrays are owned
+    vector<uint32_t> targets;
+    vector<int32_t> weights;
+    bool sorted = false;       // neighbour lists ascending, so hasEdge can binary search
+
+    friend class DenseGraph;
+
+public:
+    SparseGraph() : view() {}
+
+    // Uses the arrays in place; they must outlive this object
+    static SparseGraph borrow(const CsrView& g, bool sortedLists) {
+        SparseGraph s;
+        s.view = g;
+        s.sorted = sortedLists;
+        return s;
+    }
+
+    // view points into the vectors, whose buffers survive a move but not a copy
+    SparseGraph(SparseGraph&&) = default;
+    SparseGraph& operator=(SparseGraph&&) = default;
+    SparseGraph(const SparseGraph&) = delete;
+    SparseGraph& operator=(const SparseGraph&) = delete;
+
+    const CsrView& csr() const { return view; }
+    uint64_t numVertices() const { return view.numVertices; }
+    bool isWeighted() const { return view.weights != nullptr; }
+    uint32_t degree(uint32_t u) const { return (uint32_t)view.degree(u); }
+
+    bool hasEdge(uint32_t u, uint32_t v) const { return findEdge(u, v) != UINT64_MAX; }
+    int weight(uint32_t u, uint32_t v) const {
+        uint64_t e = findEdge(u, v);
+        return e == UINT64_MAX ? 0 : view.weight(e);
+    }
+
+    uint64_t findEdge(uint32_t u, uint32_t v) const {
+        const uint32_t* first = view.targets + view.offsets[u];
+        const uint32_t* last = view.targets + view.offsets[u + 1];
+        const uint32_t* it = sorted ? lower_bound(first, last, v) : find(first, last, v);
+        return it != last && *it == v ? (uint64_t)(it - view.targets) : UINT64_MAX;
+    }
+
+    // f(v, weight) for every arc u -> v, in CSR order
+    template <class F>
+    void forEachNeighbor(uint32_t u, F f) const {
+        for (uint64_t e = view.offsets[u]; e < view.offsets[u + 1]; e++) f(view.targets[e], view.weight(e));
+    }
+
+    static uint64_t bytesFor(uint64_t n, uint64_t m, bool weighted) {
+        return (n + 1) * 8 + m * 4 + (weighted ? m * 4 : 0);
+    }
+};
+
+// Parallel conversion to CSR: row sizes by popcount, a prefix sum, then
+// every band of rows fills its own part of the arrays
+inline SparseGraph DenseGraph::toSparse(unsigned numThreads) const {
+    SparseGraph s;
+    s.offsets.assign(n + 1, 0);
+    parallelForChunks(n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+        for (uint64_t u = begin; u < end; u++) s.offsets[u + 1] = degree((uint32_t)u);
+    });
+    for (uint64_t u = 0; u < n; u++) s.offsets[u + 1] += s.offsets[u];
+    s.targets.resize(s.offsets[n]);
+    if (isWeighted()) s.weights.resize(s.offsets[n]);
+    parallelForChunks(n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+        for (uint64_t u = begin; u < end; u++) {
+            uint64_t e = s.offsets[u];
+            forEachNeighbor((uint32_t)u, [&](uint32_t v, int w) {
+                s.targets[e] = v;
+                if (isWeighted()) s.weights[e] = w;
+                e++;
+            });
+        }
+    });
+    s.view.numVertices = n;
+    s.view.numEdges = s.offsets[n];
+    s.view.offsets = s.offsets.data();
+    s.view.targets = s.targets.data();
+    s.view.weights = isWeighted() ? s.weights.data() : nullptr;
+    s.sorted = true;
+    return s;
+}
+
+class AdaptiveGraph {
+public:
+    enum Kind { DENSE, SPARSE };
+
+    // The matrix is chosen while it needs at most DENSE_MEMORY_RATIO times
+    // the memory of the CSR arrays: from a density of about 1/64 for bit
+    // rows alone, about 1/4 with a weight matrix. It is never built past
+    // DENSE_MAX_BYTES. Graphs of at most 64 vertices are always dense:
+    // a row is a single word.
+    static const uint64_t DENSE_MEMORY_RATIO = 2;
+    static const uint64_t DENSE_MAX_BYTES = 256ULL << 20;
+    static const uint64_t ALWAYS_DENSE_VERTICES = 64;
+
+private:
+    Kind current = SPARSE;
+    DenseGraph dense;
+    SparseGraph sparse;
+    unsigned numThreads;
+
+public:
+    AdaptiveGraph(unsigned threads = defaultThreadCount()) : numThreads(max(1u, threads)) {}
+
+    static double density(uint64_t n, uint64_t m) {
+        return n == 0 ? 0 : (double)m / ((double)n * n);
+    }
+
+    static Kind choose(uint64_t n, uint64_t m, bool weighted) {
+        if (DenseGraph::bytesFor(n, weighted) > DENSE_MAX_BYTES) return SPARSE;
+        if (n <= ALWAYS_DENSE_VERTICES) return DENSE;
+        uint64_t sparseBytes = SparseGraph::bytesFor(n, m, weighted);
+        return DenseGraph::bytesFor(n, weighted) <= DENSE_MEMORY_RATIO * sparseBytes ? DENSE : SPARSE;
+    }
+
+    // Takes the graph in CSR form and keeps whichever representation
+    // choose() picks. A sparse result borrows `g`, so it must stay alive.
+    void assign(const CsrView& g, bool sortedLists) {
+        if (choose(g.numVertices, g.numEdges, g.weights != nullptr) == DENSE) {
+            dense = DenseGraph::fromCsr(g, numThreads);
+            sparse = SparseGraph();
+            current = DENSE;
+        } else {
+            sparse = SparseGraph::borrow(g, sortedLists);
+            dense = DenseGraph();
+            current = SPARSE;
+        }
+    }
+
+    Kind kind() const { return current; }
+    uint64_t numVertices() const {
+        return current == DENSE ? dense.numVertices() : sparse.numVertices();
+    }
+
+    // Switch representation in place (parallel conversion)
+    void convertTo(Kind target) {
+        if (target == current) return;
+        if (target == DENSE) {
+            dense = DenseGraph::fromCsr(sparse.csr(), numThreads);
+            sparse = SparseGraph();
+        } else {
+            sparse = dense.toSparse(numThreads);
+            dense = DenseGraph();
+        }
+        current = target;
+    }
+
+    // Calls f(graph) with the DenseGraph or SparseGraph held; f is usually
+    // a generic lambda, so each representation gets its own compiled kernel
+    template <class F>
+    auto dispatch(F f) const -> decltype(f(declval<const SparseGraph&>())) {
+        return current == DENSE ? f(dense) : f(sparse);
+    }
+};
+
+// ----- Kernels, generic over the representation -----
+
+template <class G>
+vector<uint32_t> outDegrees(const G& g, unsigned numThreads = defaultThreadCount()) {
+    vector<uint32_t> degrees(g.numVertices());
+    parallelForChunks(g.numVertices(), numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+        for (uint64_t u = begin; u < end; u++) degrees[u] = g.degree((uint32_t)u);
+    });
+    return degrees;
+}
+
+// BFS level of every vertex from `source` (-1 if unreachable)
+template <class G>
+vector<int> bfsLevels(const G& g, uint32_t source) {
+    vector<int> level(g.numVertices(), -1);
+    vector<uint32_t> q = {source};
+    level[source] = 0;
+    for (size_t head = 0; head < q.size(); head++) {
+        uint32_t u = q[head];
+        g.forEachNeighbor(u, [&](uint32_t v, int) {
+            if (level[v] < 0) {
+                level[v] = level[u] + 1;
+                q.push_back(v);
+            }
+        });
+    }
+    return level;
+}
+
+// Dense version: the next frontier is the OR of the frontier's rows with
+// the visited vertices masked out, 64 vertices per operation
+inline vector<int> bfsLevels(const DenseGraph& g, uint32_t source) {
+    uint64_t n = g.numVertices(), words = g.rowWords();
+    vector<int> level(n, -1);
+    vector<uint64_t> visited(words, 0), frontier(words, 0), next(words);
+    visited[source / 64] = frontier[source / 64] = 1ULL << (source % 64);
+    level[source] = 0;
+    for (int depth = 1;; depth++) {
+        fill(next.begin(), next.end(), 0);
+        for (uint64_t x = 0; x < words; x++) {
+            for (uint64_t m = frontier[x]; m; m &= m - 1) {
+                const uint64_t* row = g.row((uint32_t)(x * 64 + __builtin_ctzll(m)));
+                for (uint64_t y = 0; y < words; y++) next[y] |= row[y];
+            }
+        }
+        bool any = false;
+        for (uint64_t x = 0; x < words; x++) {
+            next[x] &= ~visited[x];
+            visited[x] |= next[x];
+            any |= next[x] != 0;
+            for (uint64_t m = next[x]; m; m &= m - 1) level[x * 64 + __builtin_ctzll(m)] = depth;
+        }
+        if (!any) break;
+        frontier.swap(next);
+    }
+    return level;
+}
+
+#endif
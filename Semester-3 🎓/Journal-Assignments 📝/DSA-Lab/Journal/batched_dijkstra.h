@@ -0,0 +1,198 @@
+#ifndef DSA_BATCHED_DIJKSTRA_H
+#define DSA_BATCHED_DIJKSTRA_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <climits>
+#include <cstdint>
+#include "graph_file.h"
+#include "parallel.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+// Shortest paths from K sources at once (K = 8 or 16 "lanes"), for
+// workloads that need distances from many vertices, such as landmarks or
+// centrality.
+//
+// Every vertex keeps its K distances next to each other, so one scan of
+// an edge u -> v relaxes all K lanes with a few SIMD compare/min
+// operations (AVX2 or SSE2, plain loops elsewhere). The search is
+// label-correcting: a vertex enters the heap keyed by the smallest of its
+// lanes that improved since it was last scanned, and a scan pushes all its
+// lanes on. Lanes that are not final yet get corrected by a later scan,
+// so the result equals K separate runs of Dijkstra (non-negative weights),
+// while sources whose searches overlap share most of the scans.
+//
+// Lanes hold 32-bit distances (sums saturate instead of wrapping). Where
+// a shortest path could exceed that, fitsLanes() is false and callers use
+// the 64-bit single-source version instead. Negative weights would wrap
+// the saturation limit, so callers must reject them first (see
+// CsrView::minWeight()). All buffers live in the
+// object and are reused from one batch to the next.
+
+template <int K>
+class BatchedDijkstra {
+    static_assert(K % 8 == 0, "lanes come in groups of 8");
+
+public:
+    static const int32_t UNREACHED = INT32_MAX;
+    static const uint32_t NO_PARENT = UINT32_MAX;
+
+private:
+    CsrView g;
+    vector<int32_t> dist;      // dist[v * K + lane]
+    vector<uint32_t> parent;   // parent[v * K + lane]
+    vector<int32_t> pending;   // smallest improved lane not yet scanned, or UNREACHED
+    vector<pair<int32_t, uint32_t>> heap;  // (key, vertex), min-heap via greater<>
+    uint64_t scans = 0;
+
+    // Relaxes all lanes of v through u -> v; returns a bitmask of the
+    // lanes that improved
+    static uint32_t relaxLanes(const int32_t* du, int32_t* dv, uint32_t* pv, int32_t w, uint32_t u) {
+        uint32_t improved = 0;
+#if defined(__AVX2__)
+        const __m256i limit = _mm256_set1_epi32(UNREACHED - w);  // du + w saturates at UNREACHED
+        const __m256i weight = _mm256_set1_epi32(w);
+        const __m256i from = _mm256_set1_epi32((int32_t)u);
+        for (int k = 0; k < K; k += 8) {
+            __m256i candidate = _mm256_add_epi32(_mm256_min_epi32(_mm256_loadu_si256((const __m256i*)(du + k)), limit), weight);
+            __m256i current = _mm256_loadu_si256((const __m256i*)(dv + k));
+            __m256i better = _mm256_cmpgt_epi32(current, candidate);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(better));
+            if (!mask) continue;
+            improved |= (uint32_t)mask << k;
+            _mm256_storeu_si256((__m256i*)(dv + k), _mm256_min_epi32(current, candidate));
+            __m256i p = _mm256_loadu_si256((const __m256i*)(pv + k));
+            _mm256_storeu_si256((__m256i*)(pv + k), _mm256_blendv_epi8(p, from, better));
+        }
+#elif defined(__SSE2__)
+        // SSE2 has no 32-bit min, so min and select are built from compares
+        const __m128i limit = _mm_set1_epi32(UNREACHED - w);
+        const __m128i weight = _mm_set1_epi32(w);
+        const __m128i from = _mm_set1_epi32((int32_t)u);
+        for (int k = 0; k < K; k += 4) {
+            __m128i d = _mm_loadu_si128((const __m128i*)(du + k));
+            __m128i over = _mm_cmpgt_epi32(d, limit);
+            d = _mm_or_si128(_mm_and_si128(over, limit), _mm_andnot_si128(over, d));
+            __m128i candidate = _mm_add_epi32(d, weight);
+            __m128i current = _mm_loadu_si128((const __m128i*)(dv + k));
+            __m128i better = _mm_cmpgt_epi32(current, candidate);
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(better));
+            if (!mask) continue;
+            improved |= (uint32_t)mask << k;
+            _mm_storeu_si128((__m128i*)(dv + k),
+                             _mm_or_si128(_mm_and_si128(better, candidate), _mm_andnot_si128(better, current)));
+            __m128i p = _mm_loadu_si128((const __m128i*)(pv + k));
+            _mm_storeu_si128((__m128i*)(pv + k), _mm_or_si128(_mm_and_si128(better, from), _mm_andnot_si128(better, p)));
+        }
+#else
+        for (int k = 0; k < K; k++) {
+            int32_t candidate = min(du[k], UNREACHED - w) + w;
+            if (candidate < dv[k]) {
+                dv[k] = candidate;
+                pv[k] = u;
+                improved |= 1u << k;
+            }
+        }
+#endif
+        return improved;
+    }
+
+    void push(uint32_t v, int32_t key) {
+        if (key >= pending[v]) return;  // already queued with a smaller key
+        pending[v] = key;
+        heap.push_back({key, v});
+        push_heap(heap.begin(), heap.end(), greater<pair<int32_t, uint32_t>>());
+    }
+
+public:
+    BatchedDijkstra(const CsrView& graph) : g(graph) {
+        dist.resize(g.numVertices * K);
+        parent.resize(g.numVertices * K);
+        pending.resize(g.numVertices);
+    }
+
+    // True if no shortest path can overflow a 32-bit lane
+    static bool fitsLanes(const CsrView& graph) {
+        int64_t maxWeight = 1;
+        for (uint64_t e = 0; graph.weights && e < graph.numEdges; e++) maxWeight = max<int64_t>(maxWeight, graph.weights[e]);
+        return (double)maxWeight * graph.numVertices < (double)UNREACHED;
+    }
+
+    // Distances from sources[0..count), count <= K; lane i belongs to
+    // sources[i] and unused lanes stay unreached
+    void run(const uint32_t* sources, int count) {
+        fill(dist.begin(), dist.end(), UNREACHED);
+        fill(parent.begin(), parent.end(), NO_PARENT);
+        fill(pending.begin(), pending.end(), UNREACHED);
+        heap.clear();
+        scans = 0;
+        for (int i = 0; i < count; i++) {
+            dist[(uint64_t)sources[i] * K + i] = 0;
+            push(sources[i], 0);
+        }
+
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), greater<pair<int32_t, uint32_t>>());
+            int32_t key = heap.back().first;
+            uint32_t u = heap.back().second;
+            heap.pop_back();
+            if (key != pending[u]) continue;  // stale: u was scanned or re-queued since
+            pending[u] = UNREACHED;
+            scans++;
+
+            const int32_t* du = &dist[(uint64_t)u * K];
+            for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                uint32_t v = g.targets[e];
+                int32_t* dv = &dist[(uint64_t)v * K];
+                uint32_t improved = relaxLanes(du, dv, &parent[(uint64_t)v * K], g.weight(e), u);
+                if (!improved) continue;
+                int32_t key = UNREACHED;
+                for (uint32_t m = improved; m; m &= m - 1) key = min(key, dv[__builtin_ctz(m)]);
+                push(v, key);
+            }
+        }
+    }
+
+    // -1 if v is unreachable from the lane's source
+    int64_t distance(uint32_t v, int lane) const {
+        int32_t d = dist[(uint64_t)v * K + lane];
+        return d == UNREACHED ? -1 : d;
+    }
+
+    // -1 for the source itself and for unreachable vertices
+    int64_t parentOf(uint32_t v, int lane) const {
+        uint32_t p = parent[(uint64_t)v * K + lane];
+        return p == NO_PARENT ? -1 : (int64_t)p;
+    }
+
+    // Vertex scans of the last run; K separate runs would need up to
+    // K times the vertex count
+    uint64_t scanCount() const { return scans; }
+};
+
+// Runs all `sources` in batches of K, spread over `numThreads` threads
+// with one BatchedDijkstra (and its buffers) per thread. After each batch
+// onBatch(first, count, search) is called on the thread that ran it, with
+// lane i of `search` belonging to sources[first + i].
+template <int K, class F>
+void batchedDijkstra(const CsrView& g, const vector<uint32_t>& sources, unsigned numThreads, F onBatch) {
+    uint64_t batches = (sources.size() + K - 1) / K;
+    numThreads = (unsigned)max<uint64_t>(1, min<uint64_t>(numThreads, batches));
+    vector<unique_ptr<BatchedDijkstra<K>>> searches(numThreads);
+    parallelForDynamic(batches, numThreads, [&](unsigned t, uint64_t b) {
+        if (!searches[t]) searches[t].reset(new BatchedDijkstra<K>(g));
+        uint64_t first = b * K;
+        int count = (int)min<uint64_t>(K, sources.size() - first);
+        searches[t]->run(sources.data() + first, count);
+        onBatch(first, count, *searches[t]);
+    });
+}
+
+#endif
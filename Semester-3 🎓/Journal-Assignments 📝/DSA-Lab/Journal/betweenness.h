@@ -0,0 +1,232 @@
+#ifndef DSA_BETWEENNESS_H
+#define DSA_BETWEENNESS_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include "graph_file.h"
+#include "parallel.h"
+#include "graph_instrumentation.h"
+using namespace std;
+
+// Vertex betweenness centrality by Brandes' algorithm: for every vertex v,
+// the sum over all pairs s != v != t of the fraction of shortest s-t paths
+// that pass through v.
+//
+// One search per source s, BFS on unweighted graphs and Dijkstra on
+// weighted ones, counts the shortest paths sigma[v] from s to every v and
+// lists the vertices in the order they were settled. Walking that list
+// backwards gives each vertex its dependency on s,
+//   delta[v] = sum over shortest-path edges v -> w of sigma[v] / sigma[w] * (1 + delta[w])
+// which is added to its centrality. Shortest-path edges are recognized by
+// dist[w] == dist[v] + weight, so no predecessor lists are stored.
+//
+// Sources are handed to the threads one at a time, as searches differ a
+// lot in cost. Every thread has its own search buffers and its own
+// centrality array, and the arrays are added up at the end. After each
+// search only the entries it reached are cleared, so sources in small
+// components stay cheap.
+//
+// Which thread runs which source depends on timing, and floating-point
+// sums depend on their order, so the dependencies are added up in fixed
+// point instead: rounded to betweennessFractionBits(n) binary places and
+// summed as integers, which gives the same result for any thread count
+// and schedule. A vertex's centrality stays below n^2, so that many bits
+// still leave room in 63; the rounding costs at most 2^-bits per source.
+//
+// With epsilon > 0 only a uniform sample of sources is searched and the
+// sums are scaled by n / samples (Brandes and Pich). The sample size
+//   ln(2n / delta) / (2 epsilon^2)
+// keeps every vertex within epsilon * n(n - 2) of its exact centrality
+// with probability at least 1 - delta (Hoeffding's bound, taken over all
+// n vertices). Setting `samples` instead fixes the number of sources.
+//
+// Weights must be positive (callers check CsrView::minWeight()); self-loops
+// are ignored. Undirected graphs
+// store each edge both ways, which counts every path twice, so their
+// sums are halved.
+
+struct BetweennessOptions {
+    bool weighted = false;    // Dijkstra over the edge weights, else BFS
+    bool undirected = false;  // halve the sums (see above)
+    unsigned numThreads = defaultThreadCount();
+    double epsilon = 0;       // 0 for the exact result, else sample sources
+    double delta = 0.1;       // chance that a sampled result misses epsilon
+    uint64_t samples = 0;     // if set, the number of sampled sources instead
+    uint64_t seed = 1;        // picks the sampled sources
+};
+
+struct BetweennessResult {
+    vector<double> centrality;
+    uint64_t sources = 0;     // searches run
+    bool sampled = false;
+};
+
+// Sources needed for the sampled bound; at least n means exact
+inline uint64_t betweennessSamples(uint64_t n, double epsilon, double delta) {
+    if (epsilon <= 0 || n < 2) return n;
+    double k = ceil(log(2.0 * n / delta) / (2 * epsilon * epsilon));
+    return k >= (double)n ? n : (uint64_t)k;
+}
+
+// Binary places kept by the fixed-point sums, for n vertices
+inline int betweennessFractionBits(uint64_t n) {
+    int bits = 62;
+    for (uint64_t m = 1; m < n && bits > 0; m <<= 1) bits -= 2;
+    return min(max(bits, 0), 40);
+}
+
+// Buffers of one thread: runs the search from one source at a time and
+// adds the dependencies into `centrality`, in units of 2^-bits
+class BrandesSearch {
+private:
+    CsrView g;
+    bool weighted;
+    vector<int64_t> dist;    // -1 if not reached
+    vector<double> sigma;    // shortest paths from the source
+    vector<double> delta;    // dependency of the source on the vertex
+    vector<uint32_t> order;  // reached vertices by distance
+    vector<pair<int64_t, uint32_t>> heap;  // (distance, vertex), min-heap via greater<>
+    double unit;             // 2^bits
+
+    // Queue for the BFS is `order` itself, read from the front
+    void bfs(uint32_t s) {
+        order.push_back(s);
+        for (size_t head = 0; head < order.size(); head++) {
+            uint32_t u = order[head];
+            int64_t next = dist[u] + 1;
+            for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                uint32_t v = g.targets[e];
+                if (dist[v] < 0) {
+                    dist[v] = next;
+                    order.push_back(v);
+                }
+                if (dist[v] == next) sigma[v] += sigma[u];
+            }
+        }
+    }
+
+    // A vertex enters `order` when it is popped with its final distance;
+    // ties add up path counts instead of replacing them
+    void dijkstra(uint32_t s) {
+        heap.push_back({0, s});
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), greater<pair<int64_t, uint32_t>>());
+            int64_t d = heap.back().first;
+            uint32_t u = heap.back().second;
+            heap.pop_back();
+            if (d != dist[u]) continue;  // stale: improved since
+            order.push_back(u);
+            for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                uint32_t v = g.targets[e];
+                if (v == u) continue;
+                int64_t candidate = d + g.weights[e];
+                if (dist[v] < 0 || candidate < dist[v]) {
+                    dist[v] = candidate;
+                    sigma[v] = sigma[u];
+                    heap.push_back({candidate, v});
+                    push_heap(heap.begin(), heap.end(), greater<pair<int64_t, uint32_t>>());
+                } else if (candidate == dist[v]) {
+                    sigma[v] += sigma[u];
+                }
+            }
+        }
+    }
+
+public:
+    vector<int64_t> centrality;
+
+    BrandesSearch(const CsrView& graph, bool useWeights, int bits)
+        : g(graph), weighted(useWeights && graph.weights), unit(ldexp(1.0, bits)) {
+        dist.assign(g.numVertices, -1);
+        sigma.assign(g.numVertices, 0);
+        delta.assign(g.numVertices, 0);
+        centrality.assign(g.numVertices, 0);
+    }
+
+    void run(uint32_t s) {
+        dist[s] = 0;
+        sigma[s] = 1;
+        if (weighted) dijkstra(s);
+        else bfs(s);
+        INSTRUMENT_COUNT(verticesVisited, order.size());
+
+        // Farthest first, so delta[w] is complete before any v uses it
+        for (size_t i = order.size(); i-- > 0;) {
+            uint32_t v = order[i];
+            double sum = 0;
+            for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                uint32_t w = g.targets[e];
+                if (w != v && dist[w] == dist[v] + (weighted ? g.weights[e] : 1)) sum += (1 + delta[w]) / sigma[w];
+            }
+            INSTRUMENT_COUNT(edgesScanned, g.degree(v));
+            delta[v] = sigma[v] * sum;
+            if (v != s) centrality[v] += (int64_t)(delta[v] * unit + 0.5);
+        }
+
+        for (uint32_t v : order) {
+            dist[v] = -1;
+            sigma[v] = 0;
+            delta[v] = 0;
+        }
+        order.clear();
+    }
+};
+
+inline BetweennessResult betweennessCentrality(const CsrView& g, const BetweennessOptions& options) {
+    BetweennessResult result;
+    uint64_t n = g.numVertices;
+    result.centrality.assign(n, 0);
+    if (n == 0) return result;
+
+    // Exact runs use every vertex; sampled runs the first k of a shuffle
+    uint64_t k = options.samples ? min(options.samples, n) : betweennessSamples(n, options.epsilon, options.delta);
+    vector<uint32_t> sources(n);
+    for (uint64_t v = 0; v < n; v++) sources[v] = (uint32_t)v;
+    if (k < n) {
+        mt19937_64 rng(options.seed);
+        for (uint64_t i = 0; i < k; i++) swap(sources[i], sources[i + rng() % (n - i)]);
+        sources.resize(k);
+        result.sampled = true;
+    }
+    result.sources = k;
+
+    unsigned numThreads = (unsigned)max<uint64_t>(1, min<uint64_t>(options.numThreads, k));
+    int bits = betweennessFractionBits(n);
+    vector<unique_ptr<BrandesSearch>> searches(numThreads);
+    parallelForDynamic(k, numThreads, [&](unsigned t, uint64_t i) {
+        if (!searches[t]) searches[t].reset(new BrandesSearch(g, options.weighted, bits));
+        searches[t]->run(sources[i]);
+    });
+
+    // Sum of the per-thread arrays, split over the vertices
+    double scale = ldexp((double)n / k * (options.undirected ? 0.5 : 1.0), -bits);
+    parallelForChunks(n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+        for (uint64_t v = begin; v < end; v++) {
+            int64_t sum = 0;
+            for (const unique_ptr<BrandesSearch>& search : searches) {
+                if (search) sum += search->centrality[v];
+            }
+            result.centrality[v] = sum * scale;
+        }
+    });
+    return result;
+}
+
+// The `count` most central vertices, most central first
+inline vector<uint32_t> mostCentral(const vector<double>& centrality, size_t count) {
+    vector<uint32_t> vertices(centrality.size());
+    for (size_t v = 0; v < vertices.size(); v++) vertices[v] = (uint32_t)v;
+    count = min(count, vertices.size());
+    partial_sort(vertices.begin(), vertices.begin() + count, vertices.end(), [&](uint32_t a, uint32_t b) {
+        return centrality[a] != centrality[b] ? centrality[a] > centrality[b] : a < b;
+    });
+    vertices.resize(count);
+    return vertices;
+}
+
+#endif
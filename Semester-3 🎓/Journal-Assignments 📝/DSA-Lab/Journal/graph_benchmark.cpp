@@ -0,0 +1,436 @@
+#define DSA_JOURNAL_NO_MAIN
+#include "question2_dfs_bfs_traversal.cpp"
+#include "question3_clique_detection.cpp"
+#include "question4_prime_graph_dijkstra.cpp"
+#include "graph_generators.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/resource.h>
+using namespace std;
+
+// Benchmarks the journal's graph algorithms (DFS, BFS and betweenness
+// from question 2, the clique check and k-clique counting from question 3,
+// Dijkstra, betweenness and the prime ring search from question 4) on synthetic graphs far larger
+// than the examples: R-MAT, a 2D grid, Erdős–Rényi and the prime sum graph.
+//
+// Every generated graph is written to a temporary .dsag file and loaded
+// by the question classes exactly as a user's file would be. Each
+// measurement is repeated and the best time is kept. One row is printed
+// per (graph, algorithm, thread count), as CSV or as JSON with one row per
+// line, so two revisions can be compared with diff. The checksum column
+// only depends on what the algorithms computed, never on timing, so for
+// the same options it must match between revisions.
+//
+// The traversals and Dijkstra are sequential algorithms; with T threads,
+// T queries from different sources run at once on the shared graph
+// (throughput scaling). The clique check splits the vertices between the
+// threads, and clique counting, betweenness (over a fixed sample of
+// sources) and the prime ring search are parallel themselves.
+//
+// Build: g++ -std=c++17 -O2 graph_benchmark.cpp -o graph_benchmark -pthread
+// Usage: graph_benchmark [options]
+//   --rmat SCALE     R-MAT graph with 2^SCALE vertices, 16 edges per vertex (16)
+//   --grid SIDE      SIDE x SIDE grid (512)
+//   --er N           Erdős–Rényi graph, N vertices, average degree 16 (65536)
+//   --prime N        prime sum graph on 1..N (2000)
+//   --ring N         prime ring search size, at most 64 (16)
+//   --threads LIST   comma separated thread counts (1,2,4,... up to the cores)
+//   --repeat R       runs per measurement, best one kept (3)
+//   --seed S         generator seed (1)
+//   --format F       csv or json (csv)
+//   --out PATH       write results there instead of stdout
+//   --tmp DIR        directory for the temporary graph files (/tmp)
+//   --report PATH    instrumentation report per graph as JSON; needs a build
+//                    with -DDSA_INSTRUMENT (see graph_instrumentation.h)
+// A size of 0 skips that graph.
+
+struct BenchmarkConfig {
+    int rmatScale = 16;
+    uint32_t gridSide = 512;
+    uint32_t erVertices = 65536;
+    uint32_t primeN = 2000;
+    int ringN = 16;
+    vector<unsigned> threads;
+    int repeat = 3;
+    uint64_t seed = 1;
+    string format = "csv";
+    string outPath;
+    string tmpDir = "/tmp";
+    string reportPath;
+};
+
+struct BenchmarkRow {
+    string graph;
+    uint64_t vertices = 0;
+    uint64_t arcs = 0;
+    string algorithm;
+    unsigned threads = 1;
+    uint64_t queries = 0;
+    double seconds = 0;
+    double rate = 0;       // work per second, see rateUnit
+    string rateUnit;
+    uint64_t peakMemoryKb = 0;
+    uint64_t checksum = 0;
+};
+
+// Peak resident memory of one measurement. Linux lets the peak be reset
+// through /proc/self/clear_refs; elsewhere the peak of the whole process
+// (getrusage) is reported.
+void resetPeakMemory() {
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f) {
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+uint64_t peakMemoryKb() {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f) {
+        char line[256];
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                fclose(f);
+                return strtoull(line + 6, nullptr, 10);
+            }
+        }
+        fclose(f);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Folds every result record into a hash, so a benchmark run also checks
+// that the algorithms still produce the same output
+class ChecksumSink : public ResultSink {
+public:
+    uint64_t hash = 0;
+
+    void listVertex(uint32_t v) override { hash = mixHash(hash + v); }
+    void settled(uint32_t v, int64_t dist, int64_t) override {
+        hash = mixHash(hash + v * 0x9e3779b97f4a7c15ULL + (uint64_t)dist);
+    }
+    // Batches finish in any order, so these records are summed, not chained
+    void distance(uint32_t source, uint32_t v, int64_t dist) override {
+        hash += mixHash(((uint64_t)source << 32 | v) + (uint64_t)dist * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+class GraphBenchmark {
+private:
+    BenchmarkConfig config;
+    vector<BenchmarkRow> rows;
+    ostringstream reports;  // "graph": {instrumentation report}, ...
+
+    void addReport(const string& graph) {
+        ostringstream report;
+        instrumentReport(report);
+        instrumentReset();
+        string text = report.str();
+        text.pop_back();  // the final newline, so a comma can follow
+        reports << (reports.tellp() > 0 ? ",\n" : "") << "\"" << graph << "\": " << text;
+    }
+
+    // Runs `run` config.repeat times and records the best time. `run`
+    // returns the work done (for the rate) and sets the checksum.
+    template <class F>
+    void measure(BenchmarkRow row, F run) {
+        resetPeakMemory();
+        double best = -1;
+        uint64_t work = 0;
+        for (int r = 0; r < config.repeat; r++) {
+            auto begin = chrono::steady_clock::now();
+            work = run(row.checksum);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            if (best < 0 || seconds < best) best = seconds;
+        }
+        row.seconds = best;
+        row.rate = best > 0 ? work / best : 0;
+        row.peakMemoryKb = peakMemoryKb();
+        rows.push_back(row);
+        cerr << "  " << row.algorithm << ", " << row.threads << " threads: " << row.seconds << " s" << endl;
+    }
+
+    // Start vertices of the concurrent queries: spread over the graph,
+    // same on every run, never isolated (if the graph has edges at all)
+    vector<uint32_t> pickSources(const CsrView& adj, unsigned count) {
+        vector<uint32_t> sources;
+        for (unsigned k = 0; k < count; k++) {
+            uint64_t v = mixHash(config.seed + k) % adj.numVertices;
+            for (uint64_t tries = 0; tries < adj.numVertices && adj.degree(v) == 0; tries++) {
+                v = (v + 1) % adj.numVertices;
+            }
+            sources.push_back((uint32_t)v);
+        }
+        return sources;
+    }
+
+    void benchmarkGraph(const EdgeList& g, bool weighted) {
+        string path = config.tmpDir + "/graph_benchmark-" + g.name + ".dsag";
+        if (!writeEdgeList(path, g, weighted)) return;
+
+        GraphFile file;
+        GraphTraversal traversal;
+        Graph cliques(0);
+        DijkstraGraph dijkstra(0);
+        if (!file.open(path) || !traversal.loadFromFile(path) || !cliques.loadFromFile(path) ||
+            !dijkstra.loadFromFile(path)) {
+            remove(path.c_str());
+            return;
+        }
+        CsrView adj = file.view();
+        cerr << g.name << ": " << adj.numVertices << " vertices, " << adj.numEdges << " arcs" << endl;
+
+        unsigned maxThreads = *max_element(config.threads.begin(), config.threads.end());
+        vector<uint32_t> sources = pickSources(adj, maxThreads);
+
+        BenchmarkRow base;
+        base.graph = g.name;
+        base.vertices = adj.numVertices;
+        base.arcs = adj.numEdges;
+
+        for (unsigned threads : config.threads) {
+            BenchmarkRow row = base;
+            row.threads = threads;
+            row.queries = threads;
+            row.rateUnit = "edges/s";
+
+            // One query per thread; the checksums are summed so they do not
+            // depend on which thread finished first
+            auto queries = [&](function<void(uint32_t, ResultSink&)> query) {
+                return [&, query](uint64_t& checksum) {
+                    vector<uint64_t> sums(threads, 0);
+                    parallelForChunks(threads, threads, [&](unsigned t, uint64_t begin, uint64_t end) {
+                        for (uint64_t q = begin; q < end; q++) {
+                            ChecksumSink sink;
+                            query(sources[q], sink);
+                            sums[t] += sink.hash;
+                        }
+                    });
+                    checksum = 0;
+                    for (uint64_t s : sums) checksum += s;
+                    return (uint64_t)threads * adj.numEdges;
+                };
+            };
+
+            row.algorithm = "dfs";
+            measure(row, queries([&](uint32_t s, ResultSink& out) { traversal.DFS(s, out); }));
+            row.algorithm = "bfs";
+            measure(row, queries([&](uint32_t s, ResultSink& out) { traversal.BFS(s, out); }));
+            row.algorithm = "dijkstra";
+            measure(row, queries([&](uint32_t s, ResultSink& out) { dijkstra.dijkstra(s, out); }));
+
+            // Eight sources per thread, run as batched lanes
+            row.algorithm = "dijkstra-batch";
+            row.queries = 8 * threads;
+            measure(row, [&](uint64_t& checksum) {
+                ChecksumSink sink;
+                dijkstra.dijkstraMany(pickSources(adj, 8 * threads), sink, threads);
+                checksum = sink.hash;
+                return (uint64_t)row.queries * adj.numEdges;
+            });
+
+            // Brandes from the same 32 sampled sources for any thread count;
+            // betweenness.h sums in fixed point, so the centralities, and
+            // the checksum of their rounded values, do not depend on which
+            // thread ran which source
+            for (int weightedPaths = 0; weightedPaths <= 1; weightedPaths++) {
+                row.algorithm = weightedPaths ? "betweenness-dijkstra" : "betweenness-bfs";
+                row.queries = 32;
+                measure(row, [&](uint64_t& checksum) {
+                    BetweennessOptions options;
+                    options.numThreads = threads;
+                    options.samples = row.queries;
+                    options.seed = config.seed;
+                    BetweennessResult result;
+                    if (weightedPaths) dijkstra.betweenness(result, options);
+                    else result = traversal.betweenness(options);
+                    checksum = 0;
+                    for (double c : result.centrality) checksum += (uint64_t)llround(c);
+                    return row.queries * adj.numEdges;
+                });
+            }
+            
+            // Clique check of every vertex with its first three neighbours
+            row.algorithm = "clique";
+            row.queries = adj.numVertices;
+            row.rateUnit = "sets/s";
+            measure(row, [&](uint64_t& checksum) {
+                vector<uint64_t> found(threads, 0);
+                parallelForChunks(adj.numVertices, threads, [&](unsigned t, uint64_t begin, uint64_t end) {
+                    INSTRUMENT_SCOPE("clique");
+                    vector<uint32_t> nodes;
+                    for (uint64_t v = begin; v < end; v++) {
+                        nodes.assign(1, (uint32_t)v);
+                        for (uint64_t e = adj.offsets[v]; e < adj.offsets[v + 1] && nodes.size() < 4; e++) {
+                            nodes.push_back(adj.targets[e]);
+                        }
+                        found[t] += cliques.isCliqueByIndex(nodes);
+                    }
+                });
+                checksum = 0;
+                for (uint64_t f : found) checksum += f;
+                return adj.numVertices;
+            });
+
+            // k-clique counting over the whole graph (clique_counting.h)
+            for (int k = 3; k <= 4; k++) {
+                row.algorithm = to_string(k) + "-cliques";
+                row.queries = 1;
+                row.rateUnit = "edges/s";
+                measure(row, [&](uint64_t& checksum) {
+                    CliqueCountOptions options;
+                    options.k = k;
+                    options.numThreads = threads;
+                    checksum = cliques.countCliques(options).total;
+                    return adj.numEdges;
+                });
+            }
+        }
+
+        file.close();
+        remove(path.c_str());
+        addReport(g.name);
+    }
+
+    void benchmarkPrimeRing() {
+        for (unsigned threads : config.threads) {
+            BenchmarkRow row;
+            row.graph = "prime-" + to_string(config.ringN);
+            row.vertices = config.ringN;
+            row.algorithm = "prime-ring";
+            row.threads = threads;
+            row.queries = 1;
+            row.rateUnit = "nodes/s";
+
+            PrimeGraph pg(config.ringN);
+            HamiltonianOptions options;
+            options.numThreads = threads;
+            measure(row, [&](uint64_t& checksum) {
+                HamiltonianResult result = pg.findPrimeRings(options);
+                checksum = result.solutions;
+                return result.nodes;
+            });
+        }
+        addReport("prime-ring-" + to_string(config.ringN));
+    }
+
+    void writeCsv(FILE* out) {
+        fprintf(out, "graph,vertices,arcs,algorithm,threads,queries,seconds,rate,rate_unit,peak_memory_kb,checksum\n");
+        for (const BenchmarkRow& r : rows) {
+            fprintf(out, "%s,%llu,%llu,%s,%u,%llu,%.6f,%.0f,%s,%llu,%016llx\n",
+                    r.graph.c_str(), (unsigned long long)r.vertices, (unsigned long long)r.arcs,
+                    r.algorithm.c_str(), r.threads, (unsigned long long)r.queries, r.seconds, r.rate,
+                    r.rateUnit.c_str(), (unsigned long long)r.peakMemoryKb, (unsigned long long)r.checksum);
+        }
+    }
+
+    void writeJson(FILE* out) {
+        fprintf(out, "[\n");
+        for (size_t i = 0; i < rows.size(); i++) {
+            const BenchmarkRow& r = rows[i];
+            fprintf(out, "  {\"graph\": \"%s\", \"vertices\": %llu, \"arcs\": %llu, \"algorithm\": \"%s\", "
+                    "\"threads\": %u, \"queries\": %llu, \"seconds\": %.6f, \"rate\": %.0f, "
+                    "\"rate_unit\": \"%s\", \"peak_memory_kb\": %llu, \"checksum\": \"%016llx\"}%s\n",
+                    r.graph.c_str(), (unsigned long long)r.vertices, (unsigned long long)r.arcs,
+                    r.algorithm.c_str(), r.threads, (unsigned long long)r.queries, r.seconds, r.rate,
+                    r.rateUnit.c_str(), (unsigned long long)r.peakMemoryKb, (unsigned long long)r.checksum,
+                    i + 1 < rows.size() ? "," : "");
+        }
+        fprintf(out, "]\n");
+    }
+
+public:
+    GraphBenchmark(const BenchmarkConfig& cfg) : config(cfg) {}
+
+    bool run() {
+        instrumentReset();
+        if (config.rmatScale > 0) benchmarkGraph(rmatGraph(config.rmatScale, 16, config.seed), true);
+        if (config.gridSide > 0) benchmarkGraph(gridGraph(config.gridSide, config.gridSide), true);
+        if (config.erVertices > 0) benchmarkGraph(erdosRenyiGraph(config.erVertices, 16, config.seed), true);
+        if (config.primeN > 0) benchmarkGraph(primeSumGraph(config.primeN), false);
+        if (config.ringN > 0) benchmarkPrimeRing();
+
+        FILE* out = config.outPath.empty() ? stdout : fopen(config.outPath.c_str(), "w");
+        if (!out) {
+            cerr << "Error: cannot create " << config.outPath << endl;
+            return false;
+        }
+        if (config.format == "json") writeJson(out);
+        else writeCsv(out);
+        if (out != stdout) fclose(out);
+
+        if (!config.reportPath.empty()) {
+            ofstream report(config.reportPath);
+            report << "{\n" << reports.str() << "\n}\n";
+            if (!report) {
+                cerr << "Error: cannot write " << config.reportPath << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+bool parseThreadList(const string& text, vector<unsigned>& threads) {
+    threads.clear();
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == string::npos) comma = text.size();
+        int value = atoi(text.substr(pos, comma - pos).c_str());
+        if (value < 1) return false;
+        threads.push_back(value);
+        pos = comma + 1;
+    }
+    return !threads.empty();
+}
+
+int main(int argc, char** argv) {
+    BenchmarkConfig config;
+    for (unsigned t = 1; t < defaultThreadCount(); t *= 2) config.threads.push_back(t);
+    config.threads.push_back(defaultThreadCount());
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Error: " << option << " needs a value" << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (option == "--rmat") config.rmatScale = atoi(value.c_str());
+        else if (option == "--grid") config.gridSide = atoi(value.c_str());
+        else if (option == "--er") config.erVertices = atoi(value.c_str());
+        else if (option == "--prime") config.primeN = atoi(value.c_str());
+        else if (option == "--ring") config.ringN = atoi(value.c_str());
+        else if (option == "--repeat") config.repeat = max(1, atoi(value.c_str()));
+        else if (option == "--seed") config.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (option == "--format") config.format = value;
+        else if (option == "--out") config.outPath = value;
+        else if (option == "--tmp") config.tmpDir = value;
+        else if (option == "--report") config.reportPath = value;
+        else if (option == "--threads") {
+            if (!parseThreadList(value, config.threads)) {
+                cerr << "Error: --threads needs a list like 1,2,4" << endl;
+                return 1;
+            }
+        } else {
+            cerr << "Unknown option: " << option << endl;
+            return 1;
+        }
+    }
+    if (config.format != "csv" && config.format != "json") {
+        cerr << "Error: --format must be csv or json" << endl;
+        return 1;
+    }
+    if (config.rmatScale > 31 || config.ringN > 64) {
+        cerr << "Error: --rmat is at most 31 and --ring at most 64" << endl;
+        return 1;
+    }
+
+    GraphBenchmark benchmark(config);
+    return benchmark.run() ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "graph_file.h"
+#include "vertex_dictionary.h"
+using namespace std;
+
+// Converts a text edge list into the binary .dsag format (see graph_file.h).
+//
+// Input: one edge per line, "from to [weight]". Blank lines and lines
+// starting with '#' or '%' are ignored. Vertex tokens are non-negative
+// integers used directly as vertex indices by default. With --labels they
+// are arbitrary names, and with --remap arbitrary 64-bit numbers; both are
+// mapped to dense indices with a VertexDictionary and stored as the label
+// table so results can be printed with the original IDs.
+//
+// Usage: graph_convert <edges.txt> <graph.dsag> [--undirected] [--labels | --remap]
+//        graph_convert --check <graph.dsag>
+//
+// --check runs the full validation pass over a .dsag that came from
+// somewhere else; the loaders only check the header and section sizes.
+
+struct EdgeListReader {
+    const char* pos;
+    const char* end;
+
+    bool atLineEnd() {
+        while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) pos++;
+        return pos >= end || *pos == '\n';
+    }
+
+    void skipLine() {
+        while (pos < end && *pos != '\n') pos++;
+        if (pos < end) pos++;
+    }
+
+    string_view nextToken() {
+        atLineEnd();
+        const char* start = pos;
+        while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n') pos++;
+        return string_view(start, pos - start);
+    }
+};
+
+bool parseUnsigned(string_view token, uint64_t& value) {
+    if (token.empty() || token.size() > 20) return false;
+    uint64_t result = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') return false;
+        uint64_t next = result * 10 + (c - '0');
+        if (next / 10 != result) return false;  // overflow
+        result = next;
+    }
+    value = result;
+    return true;
+}
+
+bool parseNumber(string_view token, int64_t& value) {
+    if (token.empty()) return false;
+    size_t i = 0;
+    bool negative = false;
+    if (token[0] == '-') {
+        negative = true;
+        i = 1;
+    }
+    if (i == token.size()) return false;
+    uint64_t magnitude;
+    if (!parseUnsigned(token.substr(i), magnitude) || magnitude > (uint64_t)INT64_MAX) return false;
+    value = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <edges.txt> <graph.dsag> [--undirected] [--labels | --remap]" << endl;
+        cerr << "       " << argv[0] << " --check <graph.dsag>" << endl;
+        return 1;
+    }
+    if (string(argv[1]) == "--check") {
+        GraphFile file;
+        if (!file.open(argv[2])) return 1;
+        string problem = file.validate();
+        if (!problem.empty()) {
+            cerr << "Error: " << argv[2] << ": " << problem << endl;
+            return 1;
+        }
+        cout << argv[2] << ": OK, " << file.numVertices() << " vertices, " << file.numEdges() << " arcs" << endl;
+        return 0;
+    }
+    string inputPath = argv[1];
+    string outputPath = argv[2];
+    bool undirected = false;
+    bool useLabels = false;
+    bool remapIds = false;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--undirected") undirected = true;
+        else if (option == "--labels") useLabels = true;
+        else if (option == "--remap") remapIds = true;
+        else {
+            cerr << "Unknown option: " << option << endl;
+            return 1;
+        }
+    }
+    if (useLabels && remapIds) {
+        cerr << "Usage: " << argv[0] << " <edges.txt> <graph.dsag> [--undirected] [--labels | --remap]" << endl;
+        cerr << "--labels and --remap cannot be combined" << endl;
+        return 1;
+    }
+
+    auto startTime = chrono::steady_clock::now();
+
+    int fd = open(inputPath.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        cerr << "Error: " << inputPath << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    const char* text = "";
+    if (st.st_size > 0) {
+        void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            cerr << "Error: " << inputPath << ": " << strerror(errno) << endl;
+            return 1;
+        }
+        madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+        text = (const char*)mapped;
+    }
+
+    // Pass 1: read every edge into flat arrays, endpoints still as
+    // external IDs (label text or 64-bit numbers)
+    vector<string_view> endLabels;
+    vector<uint64_t> endIds;
+    vector<int32_t> edgeWeight;
+    bool weighted = false;
+
+    auto readVertex = [&](string_view token, uint64_t lineNo) {
+        if (useLabels) {
+            endLabels.push_back(token);
+            return true;
+        }
+        uint64_t value;
+        if (!parseUnsigned(token, value) || (!remapIds && value >= UINT32_MAX)) {
+            cerr << "Error: line " << lineNo << ": bad vertex '" << token << "'" << endl;
+            return false;
+        }
+        endIds.push_back(value);
+        return true;
+    };
+
+    EdgeListReader reader{text, text + st.st_size};
+    uint64_t lineNo = 0;
+    while (reader.pos < reader.end) {
+        lineNo++;
+        if (reader.atLineEnd() || *reader.pos == '#' || *reader.pos == '%') {
+            reader.skipLine();
+            continue;
+        }
+        if (!readVertex(reader.nextToken(), lineNo)) return 1;
+        if (reader.atLineEnd()) {
+            cerr << "Error: line " << lineNo << ": expected 'from to [weight]'" << endl;
+            return 1;
+        }
+        if (!readVertex(reader.nextToken(), lineNo)) return 1;
+
+        int64_t w = 1;
+        if (!reader.atLineEnd()) {
+            if (!parseNumber(reader.nextToken(), w) || w < INT32_MIN || w > INT32_MAX) {
+                cerr << "Error: line " << lineNo << ": bad weight" << endl;
+                return 1;
+            }
+            weighted = true;
+        }
+        reader.skipLine();
+        edgeWeight.push_back((int32_t)w);
+    }
+
+    // Map external IDs to dense indices in one parallel bulk build
+    vector<uint32_t> endIndex;
+    vector<string> labels;
+    uint64_t numVertices = 0;
+    if (useLabels) {
+        VertexDictionary<string_view> dictionary;
+        dictionary.buildBulk(endLabels, &endIndex);
+        numVertices = dictionary.size();
+        labels.resize(numVertices);
+        for (uint64_t v = 0; v < numVertices; v++) labels[v] = string(dictionary.key(v));
+        vector<string_view>().swap(endLabels);
+    } else if (remapIds) {
+        VertexDictionary<uint64_t> dictionary;
+        dictionary.buildBulk(endIds, &endIndex);
+        numVertices = dictionary.size();
+        labels.resize(numVertices);
+        for (uint64_t v = 0; v < numVertices; v++) labels[v] = to_string(dictionary.key(v));
+        vector<uint64_t>().swap(endIds);
+    } else {
+        endIndex.resize(endIds.size());
+        for (size_t i = 0; i < endIds.size(); i++) {
+            endIndex[i] = (uint32_t)endIds[i];
+            numVertices = max(numVertices, endIds[i] + 1);
+        }
+        vector<uint64_t>().swap(endIds);
+    }
+
+    vector<uint32_t> from, to;
+    vector<int32_t> weight;
+    for (size_t i = 0; i < edgeWeight.size(); i++) {
+        uint32_t u = endIndex[2 * i];
+        uint32_t v = endIndex[2 * i + 1];
+        from.push_back(u);
+        to.push_back(v);
+        weight.push_back(edgeWeight[i]);
+        if (undirected && u != v) {
+            from.push_back(v);
+            to.push_back(u);
+            weight.push_back(edgeWeight[i]);
+        }
+    }
+    vector<uint32_t>().swap(endIndex);
+    vector<int32_t>().swap(edgeWeight);
+
+    // Pass 2: counting sort into CSR, then sort each neighbor list
+    uint64_t numEdges = from.size();
+    vector<uint64_t> offsets(numVertices + 1, 0);
+    for (uint32_t u : from) offsets[u + 1]++;
+    for (uint64_t v = 0; v < numVertices; v++) offsets[v + 1] += offsets[v];
+
+    vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+    vector<pair<uint32_t, int32_t>> arcs(numEdges);
+    for (uint64_t i = 0; i < numEdges; i++) arcs[next[from[i]]++] = {to[i], weight[i]};
+    vector<uint32_t>().swap(from);
+    vector<uint32_t>().swap(to);
+    vector<int32_t>().swap(weight);
+
+    vector<uint32_t> targets(numEdges);
+    vector<int32_t> weights(weighted ? numEdges : 0);
+    for (uint64_t v = 0; v < numVertices; v++) {
+        sort(arcs.begin() + offsets[v], arcs.begin() + offsets[v + 1]);
+        for (uint64_t e = offsets[v]; e < offsets[v + 1]; e++) {
+            targets[e] = arcs[e].first;
+            if (weighted) weights[e] = arcs[e].second;
+        }
+    }
+    vector<pair<uint32_t, int32_t>>().swap(arcs);
+
+    CsrView graph;
+    graph.numVertices = numVertices;
+    graph.numEdges = numEdges;
+    graph.offsets = offsets.data();
+    graph.targets = targets.data();
+    graph.weights = weighted ? weights.data() : nullptr;
+
+    uint32_t flags = GRAPH_FILE_SORTED | (undirected ? GRAPH_FILE_UNDIRECTED : 0);
+    if (!writeGraphFile(outputPath, graph, flags, labels)) return 1;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << "Wrote " << outputPath << ": " << numVertices << " vertices, " << numEdges << " arcs"
+         << (weighted ? ", weighted" : "") << (labels.empty() ? "" : ", labeled")
+         << " (" << seconds << " s)" << endl;
+    return 0;
+}
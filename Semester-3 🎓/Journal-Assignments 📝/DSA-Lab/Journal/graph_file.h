@@ -0,0 +1,349 @@
+#ifndef DSA_GRAPH_FILE_H
+#define DSA_GRAPH_FILE_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// Shared binary graph format (.dsag) used by every question in this journal.
+//
+// File layout (little-endian, every section starts on an 8-byte boundary):
+//   GraphFileHeader
+//   offsets[numVertices + 1]        uint64  CSR row offsets
+//   targets[numEdges]               uint32  destination of every stored arc
+//   weights[numEdges]               int32   only if GRAPH_FILE_WEIGHTED
+//   labelOffsets[numVertices + 1]   uint64  only if GRAPH_FILE_LABELED
+//   labelData[...]                  char    concatenated vertex labels
+//
+// Undirected graphs store both arcs, so numEdges counts arcs, not edges.
+// The file is padded with zeros to a multiple of 8 bytes. The loader maps
+// the file and hands out pointers into it; nothing is parsed or copied.
+
+const char GRAPH_FILE_MAGIC[8] = {'D', 'S', 'A', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t GRAPH_FILE_VERSION = 1;
+
+const uint32_t GRAPH_FILE_WEIGHTED = 1u << 0;
+const uint32_t GRAPH_FILE_LABELED = 1u << 1;
+const uint32_t GRAPH_FILE_UNDIRECTED = 1u << 2;
+const uint32_t GRAPH_FILE_SORTED = 1u << 3;  // every neighbor list is ascending
+
+struct GraphFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t numVertices;
+    uint64_t numEdges;
+    uint64_t offsetsPos;       // byte positions of each section in the file
+    uint64_t targetsPos;
+    uint64_t weightsPos;       // 0 when the section is absent
+    uint64_t labelOffsetsPos;  // 0 when the section is absent
+    uint64_t labelDataPos;
+    uint64_t fileSize;
+};
+
+// Read-only CSR adjacency. Points either at arrays owned by a graph class
+// or straight into a mapped graph file.
+struct CsrView {
+    uint64_t numVertices = 0;
+    uint64_t numEdges = 0;
+    const uint64_t* offsets = nullptr;
+    const uint32_t* targets = nullptr;
+    const int32_t* weights = nullptr;  // nullptr for unweighted graphs
+
+    uint64_t degree(uint64_t v) const { return offsets[v + 1] - offsets[v]; }
+    int32_t weight(uint64_t e) const { return weights ? weights[e] : 1; }
+
+    // Smallest edge weight, 1 for unweighted graphs (and no edges)
+    int32_t minWeight() const {
+        if (!weights || numEdges == 0) return 1;
+        return *min_element(weights, weights + numEdges);
+    }
+};
+
+// Collects edges in any order and packs them into CSR arrays.
+// Neighbors keep their insertion order, so traversals visit them exactly
+// as the old vector-of-vectors adjacency lists did.
+class CsrBuilder {
+private:
+    uint64_t numVertices = 0;
+    vector<uint32_t> edgeFrom;
+    vector<uint32_t> edgeTo;
+    vector<int32_t> edgeWeight;
+    vector<uint64_t> offsets;
+    vector<uint32_t> targets;
+    vector<int32_t> weights;
+    bool built = false;
+
+public:
+    void reset(uint64_t n) {
+        numVertices = n;
+        edgeFrom.clear();
+        edgeTo.clear();
+        edgeWeight.clear();
+        offsets.clear();
+        targets.clear();
+        weights.clear();
+        built = false;
+    }
+
+    // Vertices beyond the count given to reset() are added as needed
+    void addEdge(uint32_t from, uint32_t to, int32_t weight) {
+        numVertices = max<uint64_t>(numVertices, (uint64_t)max(from, to) + 1);
+        edgeFrom.push_back(from);
+        edgeTo.push_back(to);
+        edgeWeight.push_back(weight);
+        built = false;
+    }
+
+    // Adds an isolated vertex if `n` exceeds the current count
+    void reserveVertices(uint64_t n) {
+        if (n > numVertices) {
+            numVertices = n;
+            built = false;
+        }
+    }
+
+    uint64_t vertexCount() const { return numVertices; }
+    uint64_t edgeCount() const { return edgeFrom.size(); }
+
+    // Counting sort by source vertex (stable)
+    CsrView build() {
+        if (!built) {
+            offsets.assign(numVertices + 1, 0);
+            for (uint32_t u : edgeFrom) offsets[u + 1]++;
+            for (uint64_t v = 0; v < numVertices; v++) offsets[v + 1] += offsets[v];
+
+            targets.resize(edgeFrom.size());
+            weights.resize(edgeFrom.size());
+            vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < edgeFrom.size(); i++) {
+                uint64_t slot = next[edgeFrom[i]]++;
+                targets[slot] = edgeTo[i];
+                weights[slot] = edgeWeight[i];
+            }
+            built = true;
+        }
+
+        CsrView view;
+        view.numVertices = numVertices;
+        view.numEdges = targets.size();
+        view.offsets = offsets.data();
+        view.targets = targets.data();
+        view.weights = weights.data();
+        return view;
+    }
+};
+
+// Memory-mapped .dsag file. Nothing is copied: the kernel pages sections
+// in on first touch. open() only checks the header and that every section
+// fits in the file; validate() is the full pass over offsets, targets and
+// labels, for files that did not come from graph_convert.
+class GraphFile {
+private:
+    int fd = -1;
+    const char* base = nullptr;
+    size_t size = 0;
+    const GraphFileHeader* header = nullptr;
+
+    bool fail(const string& path, const string& reason) {
+        cerr << "Error: " << path << ": " << reason << endl;
+        close();
+        return false;
+    }
+
+    // `count` items of `itemSize` bytes at pos, without overflowing count * itemSize
+    bool sectionFits(uint64_t pos, uint64_t count, uint64_t itemSize) const {
+        return pos % 8 == 0 && pos <= size && count <= (size - pos) / itemSize;
+    }
+
+public:
+    GraphFile() {}
+    GraphFile(const GraphFile&) = delete;
+    GraphFile& operator=(const GraphFile&) = delete;
+    ~GraphFile() { close(); }
+
+    bool open(const string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail(path, strerror(errno));
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) return fail(path, strerror(errno));
+        size = (size_t)st.st_size;
+        if (size < sizeof(GraphFileHeader)) return fail(path, "file too small");
+
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) return fail(path, strerror(errno));
+        base = (const char*)mapped;
+        header = (const GraphFileHeader*)base;
+
+        if (memcmp(header->magic, GRAPH_FILE_MAGIC, 8) != 0) return fail(path, "not a graph file");
+        if (header->version != GRAPH_FILE_VERSION) return fail(path, "unsupported version");
+        if (header->fileSize != size) return fail(path, "truncated file");
+        if (header->numVertices > UINT32_MAX) return fail(path, "too many vertices");
+
+        uint64_t n = header->numVertices;
+        uint64_t m = header->numEdges;
+        if (!sectionFits(header->offsetsPos, n + 1, 8)) return fail(path, "bad offsets section");
+        if (!sectionFits(header->targetsPos, m, 4)) return fail(path, "bad targets section");
+        if ((header->flags & GRAPH_FILE_WEIGHTED) && !sectionFits(header->weightsPos, m, 4))
+            return fail(path, "bad weights section");
+        if ((header->flags & GRAPH_FILE_LABELED) && !sectionFits(header->labelOffsetsPos, n + 1, 8))
+            return fail(path, "bad label section");
+
+        const uint64_t* offsets = (const uint64_t*)(base + header->offsetsPos);
+        if (offsets[0] != 0 || offsets[n] != m) return fail(path, "bad offsets");
+        if (hasLabels()) {
+            const uint64_t* labelOffsets = (const uint64_t*)(base + header->labelOffsetsPos);
+            if (header->labelDataPos > size || labelOffsets[0] != 0 || labelOffsets[n] > size - header->labelDataPos)
+                return fail(path, "bad label data");
+        }
+        return true;
+    }
+
+    // One sequential pass: offsets and label offsets ascending, every target
+    // a vertex. Returns the first problem found, or "" if the file is sound.
+    string validate() const {
+        uint64_t n = header->numVertices;
+        const uint64_t* offsets = (const uint64_t*)(base + header->offsetsPos);
+        const uint32_t* targets = (const uint32_t*)(base + header->targetsPos);
+        for (uint64_t v = 0; v < n; v++) {
+            if (offsets[v] > offsets[v + 1]) return "offsets not ascending at vertex " + to_string(v);
+        }
+        for (uint64_t e = 0; e < header->numEdges; e++) {
+            if (targets[e] >= n) return "target out of range at arc " + to_string(e);
+        }
+        if (hasLabels()) {
+            const uint64_t* labelOffsets = (const uint64_t*)(base + header->labelOffsetsPos);
+            for (uint64_t v = 0; v < n; v++) {
+                if (labelOffsets[v] > labelOffsets[v + 1]) return "label offsets not ascending at vertex " + to_string(v);
+            }
+        }
+        return "";
+    }
+
+    void close() {
+        if (base) munmap((void*)base, size);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        base = nullptr;
+        size = 0;
+        header = nullptr;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+    uint64_t numVertices() const { return header->numVertices; }
+    uint64_t numEdges() const { return header->numEdges; }
+    bool isWeighted() const { return header->flags & GRAPH_FILE_WEIGHTED; }
+    bool hasLabels() const { return header->flags & GRAPH_FILE_LABELED; }
+    bool isUndirected() const { return header->flags & GRAPH_FILE_UNDIRECTED; }
+    bool isSorted() const { return header->flags & GRAPH_FILE_SORTED; }
+
+    CsrView view() const {
+        CsrView v;
+        v.numVertices = header->numVertices;
+        v.numEdges = header->numEdges;
+        v.offsets = (const uint64_t*)(base + header->offsetsPos);
+        v.targets = (const uint32_t*)(base + header->targetsPos);
+        v.weights = isWeighted() ? (const int32_t*)(base + header->weightsPos) : nullptr;
+        return v;
+    }
+
+    string_view label(uint64_t v) const {
+        const uint64_t* labelOffsets = (const uint64_t*)(base + header->labelOffsetsPos);
+        const char* data = base + header->labelDataPos;
+        return string_view(data + labelOffsets[v], labelOffsets[v + 1] - labelOffsets[v]);
+    }
+};
+
+// Writes a graph in .dsag format. `weights` may be null; `labels` may be
+// empty or hold exactly one label per vertex.
+inline bool writeGraphFile(const string& path, const CsrView& graph, uint32_t flags,
+                           const vector<string>& labels = {}) {
+    GraphFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GRAPH_FILE_MAGIC, 8);
+    header.version = GRAPH_FILE_VERSION;
+    header.numVertices = graph.numVertices;
+    header.numEdges = graph.numEdges;
+
+    flags &= ~(GRAPH_FILE_WEIGHTED | GRAPH_FILE_LABELED);
+    if (graph.weights) flags |= GRAPH_FILE_WEIGHTED;
+    if (!labels.empty()) flags |= GRAPH_FILE_LABELED;
+    header.flags = flags;
+
+    auto align8 = [](uint64_t pos) { return (pos + 7) & ~uint64_t(7); };
+    uint64_t pos = align8(sizeof(GraphFileHeader));
+    header.offsetsPos = pos;
+    pos = align8(pos + (graph.numVertices + 1) * 8);
+    header.targetsPos = pos;
+    pos = align8(pos + graph.numEdges * 4);
+    if (graph.weights) {
+        header.weightsPos = pos;
+        pos = align8(pos + graph.numEdges * 4);
+    }
+
+    vector<uint64_t> labelOffsets;
+    if (!labels.empty()) {
+        labelOffsets.resize(graph.numVertices + 1, 0);
+        for (uint64_t v = 0; v < graph.numVertices; v++)
+            labelOffsets[v + 1] = labelOffsets[v] + labels[v].size();
+        header.labelOffsetsPos = pos;
+        pos = align8(pos + (graph.numVertices + 1) * 8);
+        header.labelDataPos = pos;
+        pos += labelOffsets.back();
+    }
+    header.fileSize = align8(pos);
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) {
+        cerr << "Error: cannot create " << path << endl;
+        return false;
+    }
+
+    uint64_t written = 0;
+    auto put = [&](const void* data, uint64_t bytes) {
+        out.write((const char*)data, (streamsize)bytes);
+        written += bytes;
+    };
+    auto padTo = [&](uint64_t target) {
+        static const char zeros[8] = {0};
+        if (target > written) put(zeros, target - written);
+    };
+
+    put(&header, sizeof(header));
+    padTo(header.offsetsPos);
+    put(graph.offsets, (graph.numVertices + 1) * 8);
+    padTo(header.targetsPos);
+    put(graph.targets, graph.numEdges * 4);
+    if (graph.weights) {
+        padTo(header.weightsPos);
+        put(graph.weights, graph.numEdges * 4);
+    }
+    if (!labels.empty()) {
+        padTo(header.labelOffsetsPos);
+        put(labelOffsets.data(), labelOffsets.size() * 8);
+        padTo(header.labelDataPos);
+        for (const string& label : labels) put(label.data(), label.size());
+    }
+    padTo(header.fileSize);
+
+    if (!out) {
+        cerr << "Error: write to " << path << " failed" << endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef DSA_GRAPH_GENERATORS_H
+#define DSA_GRAPH_GENERATORS_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include "graph_file.h"
+#include "vertex_dictionary.h"
+using namespace std;
+
+// Synthetic undirected graphs for benchmarks. Every generator is fully
+// determined by its parameters and seed (only raw mt19937_64 output is
+// used, never the library distributions), so the same graph comes out on
+// every machine and results can be compared between revisions.
+
+struct EdgeList {
+    string name;
+    uint64_t numVertices = 0;
+    vector<pair<uint32_t, uint32_t>> edges;  // each undirected edge once
+};
+
+// Uniform double in [0, 1) from the top 53 bits
+inline double unitRandom(mt19937_64& rng) {
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// R-MAT (recursive matrix) graph as used by Graph500: 2^scale vertices and
+// edgeFactor * 2^scale edges. Each edge picks one quadrant of the adjacency
+// matrix per bit with probabilities a, b, c and 1 - a - b - c, which gives
+// the skewed, power-law-like degrees of real networks. Vertex numbers are
+// shuffled afterwards so high degree vertices are not all at small indices.
+inline EdgeList rmatGraph(int scale, int edgeFactor, uint64_t seed,
+                          double a = 0.57, double b = 0.19, double c = 0.19) {
+    EdgeList g;
+    g.name = "rmat-" + to_string(scale);
+    g.numVertices = 1ULL << scale;
+    mt19937_64 rng(seed);
+
+    uint64_t numEdges = (uint64_t)edgeFactor << scale;
+    g.edges.reserve(numEdges);
+    for (uint64_t e = 0; e < numEdges; e++) {
+        uint32_t from = 0, to = 0;
+        for (int bit = 0; bit < scale; bit++) {
+            double r = unitRandom(rng);
+            bool down = r >= a + b;              // quadrants c and d
+            bool right = (r >= a && r < a + b) || r >= a + b + c;  // quadrants b and d
+            from = (from << 1) | down;
+            to = (to << 1) | right;
+        }
+        g.edges.push_back({from, to});
+    }
+
+    vector<uint32_t> perm(g.numVertices);
+    for (uint64_t v = 0; v < perm.size(); v++) perm[v] = (uint32_t)v;
+    for (uint64_t v = perm.size(); v > 1; v--) swap(perm[v - 1], perm[rng() % v]);
+    for (auto& edge : g.edges) edge = {perm[edge.first], perm[edge.second]};
+    return g;
+}
+
+// rows x cols grid, each vertex joined to its right and lower neighbour
+inline EdgeList gridGraph(uint32_t rows, uint32_t cols) {
+    EdgeList g;
+    g.name = "grid-" + to_string(rows) + "x" + to_string(cols);
+    g.numVertices = (uint64_t)rows * cols;
+    for (uint32_t r = 0; r < rows; r++) {
+        for (uint32_t c = 0; c < cols; c++) {
+            uint32_t v = r * cols + c;
+            if (c + 1 < cols) g.edges.push_back({v, v + 1});
+            if (r + 1 < rows) g.edges.push_back({v, v + cols});
+        }
+    }
+    return g;
+}
+
+// Erdős–Rényi G(n, m) with m = n * averageDegree / 2 edges, every
+// endpoint chosen uniformly at random
+inline EdgeList erdosRenyiGraph(uint32_t n, uint32_t averageDegree, uint64_t seed) {
+    EdgeList g;
+    g.name = "er-" + to_string(n);
+    g.numVertices = n;
+    mt19937_64 rng(seed);
+    uint64_t numEdges = (uint64_t)n * averageDegree / 2;
+    g.edges.reserve(numEdges);
+    for (uint64_t e = 0; e < numEdges; e++) {
+        uint32_t from = (uint32_t)(rng() % n);
+        uint32_t to = (uint32_t)(rng() % n);
+        g.edges.push_back({from, to});
+    }
+    return g;
+}
+
+// Question 4's prime sum graph: i -- j when i + j is prime, vertices 1..N
+// (vertex 0 exists but stays isolated, as in PrimeGraph)
+inline EdgeList primeSumGraph(uint32_t n) {
+    EdgeList g;
+    g.name = "prime-" + to_string(n);
+    g.numVertices = (uint64_t)n + 1;
+
+    // Sieve of Eratosthenes up to the largest possible sum
+    vector<bool> composite(2 * (uint64_t)n + 1, false);
+    for (uint64_t p = 2; p * p < composite.size(); p++) {
+        if (composite[p]) continue;
+        for (uint64_t k = p * p; k < composite.size(); k += p) composite[k] = true;
+    }
+    for (uint32_t i = 1; i <= n; i++) {
+        for (uint32_t j = i + 1; j <= n; j++) {
+            if (!composite[i + j]) g.edges.push_back({i, j});
+        }
+    }
+    return g;
+}
+
+// Writes an EdgeList as an undirected, sorted .dsag file. Self loops and
+// repeated edges are dropped. With `weighted`, every edge gets a weight in
+// 1..100 derived from its endpoints, so both directions agree.
+inline bool writeEdgeList(const string& path, const EdgeList& g, bool weighted) {
+    uint64_t n = g.numVertices;
+    vector<uint64_t> offsets(n + 1, 0);
+    for (const auto& edge : g.edges) {
+        if (edge.first == edge.second) continue;
+        offsets[edge.first + 1]++;
+        offsets[edge.second + 1]++;
+    }
+    for (uint64_t v = 0; v < n; v++) offsets[v + 1] += offsets[v];
+
+    vector<uint32_t> targets(offsets[n]);
+    vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+    for (const auto& edge : g.edges) {
+        if (edge.first == edge.second) continue;
+        targets[next[edge.first]++] = edge.second;
+        targets[next[edge.second]++] = edge.first;
+    }
+
+    // Sort and deduplicate each neighbour list, compacting in place
+    uint64_t out = 0;
+    for (uint64_t v = 0; v < n; v++) {
+        uint32_t* first = targets.data() + offsets[v];
+        uint32_t* last = targets.data() + offsets[v + 1];
+        sort(first, last);
+        last = unique(first, last);
+        offsets[v] = out;
+        for (uint32_t* t = first; t < last; t++) targets[out++] = *t;
+    }
+    offsets[n] = out;
+    targets.resize(out);
+
+    vector<int32_t> weights;
+    if (weighted) {
+        weights.resize(out);
+        for (uint64_t v = 0; v < n; v++) {
+            for (uint64_t e = offsets[v]; e < offsets[v + 1]; e++) {
+                uint64_t lo = min<uint64_t>(v, targets[e]), hi = max<uint64_t>(v, targets[e]);
+                weights[e] = 1 + (int32_t)(mixHash(lo << 32 | hi) % 100);
+            }
+        }
+    }
+
+    CsrView view;
+    view.numVertices = n;
+    view.numEdges = out;
+    view.offsets = offsets.data();
+    view.targets = targets.data();
+    view.weights = weighted ? weights.data() : nullptr;
+    return writeGraphFile(path, view, GRAPH_FILE_UNDIRECTED | GRAPH_FILE_SORTED);
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef DSA_GRAPH_INSTRUMENTATION_H
+#define DSA_GRAPH_INSTRUMENTATION_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+// Counters and phase timers inside the graph algorithms, to see why a
+// graph is slow: how many edges were scanned, how often Dijkstra's heap
+// held stale entries, how wide each BFS level was, and so on.
+//
+// Everything here is compiled out unless DSA_INSTRUMENT is defined:
+//   g++ -DDSA_INSTRUMENT ...            counters and phase timers
+//   g++ -DDSA_INSTRUMENT -DDSA_INSTRUMENT_PERF ...
+//                                       also cache and branch misses per
+//                                       phase from Linux perf_event
+// Without DSA_INSTRUMENT the macros expand to nothing and FrontierCounter
+// is empty, so the algorithms compile to the same code as before.
+//
+// Each thread counts into its own thread_local block; instrumentReport()
+// adds them up. Call it (and instrumentReset()) while no algorithm runs.
+//
+// In the algorithms:
+//   INSTRUMENT_COUNT(edgesScanned, adj.degree(v));
+//   INSTRUMENT_SCOPE("dijkstra");       // times the rest of the block
+
+#ifdef DSA_INSTRUMENT
+
+#if defined(DSA_INSTRUMENT_PERF) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#define DSA_PERF_EVENTS 1
+#endif
+
+struct PhaseStats {
+    uint64_t calls = 0;
+    double seconds = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t branchMisses = 0;
+};
+
+struct InstrumentCounters {
+    uint64_t verticesVisited = 0;
+    uint64_t edgesScanned = 0;
+    uint64_t relaxations = 0;       // Dijkstra distance improvements
+    uint64_t heapPushes = 0;
+    uint64_t stalePops = 0;         // heap entries of already settled vertices
+    uint64_t cliquePairChecks = 0;  // adjacency tests made by the clique check
+    vector<uint64_t> bfsFrontier;   // vertices per BFS level, summed over runs
+    map<string, PhaseStats> phases;
+
+    void add(const InstrumentCounters& other) {
+        verticesVisited += other.verticesVisited;
+        edgesScanned += other.edgesScanned;
+        relaxations += other.relaxations;
+        heapPushes += other.heapPushes;
+        stalePops += other.stalePops;
+        cliquePairChecks += other.cliquePairChecks;
+        if (bfsFrontier.size() < other.bfsFrontier.size()) bfsFrontier.resize(other.bfsFrontier.size(), 0);
+        for (size_t i = 0; i < other.bfsFrontier.size(); i++) bfsFrontier[i] += other.bfsFrontier[i];
+        for (const auto& phase : other.phases) {
+            PhaseStats& stats = phases[phase.first];
+            stats.calls += phase.second.calls;
+            stats.seconds += phase.second.seconds;
+            stats.cacheMisses += phase.second.cacheMisses;
+            stats.branchMisses += phase.second.branchMisses;
+        }
+    }
+};
+
+// Blocks of all threads that have counted something. A thread's block is
+// folded into `retired` when the thread exits.
+class InstrumentRegistry {
+private:
+    mutex lock;
+    vector<InstrumentCounters*> live;
+    InstrumentCounters retired;
+
+public:
+    void attach(InstrumentCounters* counters) {
+        lock_guard<mutex> guard(lock);
+        live.push_back(counters);
+    }
+
+    void detach(InstrumentCounters* counters) {
+        lock_guard<mutex> guard(lock);
+        retired.add(*counters);
+        live.erase(find(live.begin(), live.end(), counters));
+    }
+
+    InstrumentCounters total() {
+        lock_guard<mutex> guard(lock);
+        InstrumentCounters sum = retired;
+        for (InstrumentCounters* counters : live) sum.add(*counters);
+        return sum;
+    }
+
+    void reset() {
+        lock_guard<mutex> guard(lock);
+        retired = InstrumentCounters();
+        for (InstrumentCounters* counters : live) *counters = InstrumentCounters();
+    }
+};
+
+inline InstrumentRegistry& instrumentRegistry() {
+    static InstrumentRegistry registry;
+    return registry;
+}
+
+// Hardware counters of the calling thread (user space only). Opening
+// fails without perf support or permission; phases then report no misses.
+class PerfCounters {
+private:
+    int cacheFd = -1;
+    int branchFd = -1;
+
+#ifdef DSA_PERF_EVENTS
+    static int openCounter(uint64_t config) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    static uint64_t readCounter(int fd) {
+        uint64_t value = 0;
+        if (fd < 0 || ::read(fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) return 0;
+        return value;
+    }
+#endif
+
+public:
+    PerfCounters() {
+#ifdef DSA_PERF_EVENTS
+        cacheFd = openCounter(PERF_COUNT_HW_CACHE_MISSES);
+        branchFd = openCounter(PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef DSA_PERF_EVENTS
+        if (cacheFd >= 0) ::close(cacheFd);
+        if (branchFd >= 0) ::close(branchFd);
+#endif
+    }
+
+    bool available() const { return cacheFd >= 0 || branchFd >= 0; }
+
+    void read(uint64_t& cacheMisses, uint64_t& branchMisses) const {
+#ifdef DSA_PERF_EVENTS
+        cacheMisses = readCounter(cacheFd);
+        branchMisses = readCounter(branchFd);
+#else
+        cacheMisses = branchMisses = 0;
+#endif
+    }
+};
+
+struct ThreadInstrument {
+    InstrumentCounters counters;
+    PerfCounters perf;
+
+    ThreadInstrument() { instrumentRegistry().attach(&counters); }
+    ~ThreadInstrument() { instrumentRegistry().detach(&counters); }
+};
+
+inline ThreadInstrument& threadInstrument() {
+    thread_local ThreadInstrument instrument;
+    return instrument;
+}
+
+inline InstrumentCounters& instrumentCounters() {
+    return threadInstrument().counters;
+}
+
+// Adds the time (and hardware counts) between construction and
+// destruction to the named phase of the calling thread
+class InstrumentScope {
+private:
+    const char* name;
+    chrono::steady_clock::time_point begin;
+    uint64_t cacheBegin, branchBegin;
+
+public:
+    InstrumentScope(const char* phase) : name(phase) {
+        threadInstrument().perf.read(cacheBegin, branchBegin);
+        begin = chrono::steady_clock::now();
+    }
+
+    ~InstrumentScope() {
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        ThreadInstrument& instrument = threadInstrument();
+        uint64_t cacheEnd, branchEnd;
+        instrument.perf.read(cacheEnd, branchEnd);
+        PhaseStats& stats = instrument.counters.phases[name];
+        stats.calls++;
+        stats.seconds += seconds;
+        stats.cacheMisses += cacheEnd - cacheBegin;
+        stats.branchMisses += branchEnd - branchBegin;
+    }
+};
+
+// Level sizes of a BFS over a flat array queue. Call next() with the
+// queue position about to be dequeued and finish() after the loop.
+class FrontierCounter {
+private:
+    size_t levelStart = 0;
+    size_t levelEnd = 1;  // the start vertex alone is level 0
+    size_t level = 0;
+
+    void record(size_t size) {
+        vector<uint64_t>& frontier = instrumentCounters().bfsFrontier;
+        if (frontier.size() <= level) frontier.resize(level + 1, 0);
+        frontier[level++] += size;
+    }
+
+public:
+    void next(size_t head, size_t queued) {
+        if (head != levelEnd) return;
+        record(levelEnd - levelStart);
+        levelStart = levelEnd;
+        levelEnd = queued;
+    }
+
+    void finish(size_t queued) {
+        if (queued > levelStart) record(queued - levelStart);
+    }
+};
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_COUNT(counter, n) (instrumentCounters().counter += (n))
+#define INSTRUMENT_SCOPE(phase) InstrumentScope INSTRUMENT_CONCAT(instrumentScope, __LINE__)(phase)
+
+inline void instrumentReset() { instrumentRegistry().reset(); }
+
+// Totals of all threads as one JSON object
+inline void instrumentReport(ostream& out) {
+    InstrumentCounters total = instrumentRegistry().total();
+    out << "{\n  \"instrumentation\": \"enabled\",\n";
+    out << "  \"perf_events\": " << (threadInstrument().perf.available() ? "true" : "false") << ",\n";
+    out << "  \"counters\": {\"vertices_visited\": " << total.verticesVisited
+        << ", \"edges_scanned\": " << total.edgesScanned
+        << ", \"relaxations\": " << total.relaxations
+        << ", \"heap_pushes\": " << total.heapPushes
+        << ", \"stale_pops\": " << total.stalePops
+        << ", \"clique_pair_checks\": " << total.cliquePairChecks << "},\n";
+    out << "  \"bfs_frontier\": [";
+    for (size_t i = 0; i < total.bfsFrontier.size(); i++) {
+        out << (i ? ", " : "") << total.bfsFrontier[i];
+    }
+    out << "],\n  \"phases\": [";
+    bool first = true;
+    for (const auto& phase : total.phases) {
+        out << (first ? "\n" : ",\n") << "    {\"name\": \"" << phase.first << "\", \"calls\": " << phase.second.calls
+            << ", \"seconds\": " << phase.second.seconds
+            << ", \"cache_misses\": " << phase.second.cacheMisses
+            << ", \"branch_misses\": " << phase.second.branchMisses << "}";
+        first = false;
+    }
+    out << (first ? "" : "\n  ") << "]\n}\n";
+}
+
+#else
+
+class FrontierCounter {
+public:
+    void next(size_t, size_t) {}
+    void finish(size_t) {}
+};
+
+#define INSTRUMENT_COUNT(counter, n) ((void)0)
+#define INSTRUMENT_SCOPE(phase) ((void)0)
+
+inline void instrumentReset() {}
+
+inline void instrumentReport(ostream& out) {
+    out << "{\n  \"instrumentation\": \"disabled\"\n}\n";
+}
+
+#endif
+
+#endif
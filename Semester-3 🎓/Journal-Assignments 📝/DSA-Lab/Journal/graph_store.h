@@ -0,0 +1,143 @@
+#ifndef DSA_GRAPH_STORE_H
+#define DSA_GRAPH_STORE_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdlib>
+#include "graph_file.h"
+#include "vertex_dictionary.h"
+#include "vertex_ordering.h"
+#include "result_sink.h"
+using namespace std;
+
+// Vertices and edges of one graph, shared by the graph classes of every
+// question. Edges are kept in CSR form over dense vertex indices, either
+// built in memory or mapped from a .dsag file. Vertex labels live in a
+// VertexDictionary and are only consulted to parse input and print output.
+//
+// After reorder() the edges are relabelled for locality (see
+// vertex_ordering.h): edges(), vertexName() and findVertex() then use the
+// new indices, and openOutput() maps results back to the original ones.
+class GraphStore {
+private:
+    CsrBuilder builder;                // edges added in code
+    VertexDictionary<string> names;    // labels of vertices added in code
+    GraphFile file;                    // mapped .dsag file, when one is loaded
+    unique_ptr<VertexDictionary<string_view>> fileNames;  // built on first lookup
+    unique_ptr<ReorderedGraph> reordered;                  // set by reorder()
+
+    // Label of a vertex by its index in the input (before reordering)
+    string originalName(uint32_t index) const {
+        if (file.isOpen()) {
+            return file.hasLabels() ? string(file.label(index)) : to_string(index);
+        }
+        return index < names.size() ? names.key(index) : to_string(index);
+    }
+
+    int64_t findOriginal(const string& label) {
+        if (file.isOpen() && file.hasLabels()) {
+            if (!fileNames) {
+                vector<string_view> labels(file.numVertices());
+                for (uint64_t v = 0; v < labels.size(); v++) labels[v] = file.label(v);
+                fileNames.reset(new VertexDictionary<string_view>());
+                fileNames->buildBulk(labels, nullptr);
+            }
+            return fileNames->find(label);
+        }
+        if (!file.isOpen() && names.size() > 0) {
+            return names.find(label);
+        }
+        char* end;
+        long long index = strtoll(label.c_str(), &end, 10);
+        if (label.empty() || *end != '\0' || index < 0 || (uint64_t)index >= vertexCount()) return -1;
+        return index;
+    }
+
+public:
+    // Index of the vertex with this label, adding it if new
+    uint32_t addVertex(const string& label) {
+        reordered.reset();
+        uint32_t index = names.add(label);
+        builder.reserveVertices(index + 1);
+        return index;
+    }
+
+    void addEdge(const string& from, const string& to, int weight) {
+        builder.addEdge(addVertex(from), addVertex(to), weight);
+    }
+
+    // For graphs without labels, vertices are just 0..n-1
+    void addEdge(uint32_t from, uint32_t to, int weight) {
+        reordered.reset();
+        builder.addEdge(from, to, weight);
+    }
+
+    void reserveVertices(uint64_t n) { builder.reserveVertices(n); }
+
+    // Replace everything added so far with a graph file (see graph_file.h)
+    bool loadFromFile(const string& path) {
+        fileNames.reset();
+        reordered.reset();
+        if (!file.open(path)) return false;
+        builder.reset(0);
+        names.clear();
+        return true;
+    }
+
+    bool isLoaded() const { return file.isOpen(); }
+    const GraphFile& loadedFile() const { return file; }
+
+    // Adjacency in CSR form, read straight from the file when one is loaded
+    CsrView edges() {
+        if (reordered) return reordered->view();
+        return file.isOpen() ? file.view() : builder.build();
+    }
+
+    // Relabels the vertices for locality, replacing any earlier order.
+    // ORDER_ORIGINAL returns to the indices of the input. Adding vertices
+    // or edges afterwards also drops the order.
+    void reorder(VertexOrder order, unsigned numThreads = defaultThreadCount()) {
+        reordered.reset();
+        if (order != ORDER_ORIGINAL) reordered.reset(new ReorderedGraph(edges(), order, numThreads));
+    }
+
+    bool isReordered() const { return reordered != nullptr; }
+
+    // Sink from a command line spec (see openResultSink()) for results on
+    // edges(): vertices come out in the numbering of the input, with labels
+    unique_ptr<ResultSink> openOutput(const string& spec) {
+        unique_ptr<ResultSink> out = openResultSink(spec, [this](uint32_t v) { return originalName(v); });
+        if (!out || !reordered) return out;
+        return unique_ptr<ResultSink>(new RelabelSink(move(out), reordered->originalIndices()));
+    }
+
+    uint64_t vertexCount() const {
+        return file.isOpen() ? file.numVertices() : builder.vertexCount();
+    }
+
+    uint64_t edgeCount() const {
+        return file.isOpen() ? file.numEdges() : builder.edgeCount();
+    }
+
+    // Output-time label of a dense index; unlabeled vertices print as numbers
+    string vertexName(uint32_t index) const {
+        return originalName(reordered ? reordered->originalIndex(index) : index);
+    }
+
+    // Dense index of a vertex by its index in the input
+    uint32_t currentIndex(uint32_t original) const {
+        return reordered ? reordered->currentIndex(original) : original;
+    }
+
+    // Dense index for a label from user input, or -1. Unlabeled graphs
+    // accept plain vertex numbers of the input. The dictionary for a
+    // loaded file is built in parallel the first time it is needed.
+    int64_t findVertex(const string& label) {
+        int64_t index = findOriginal(label);
+        if (index < 0 || !reordered) return index;
+        return reordered->currentIndex((uint32_t)index);
+    }
+};
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef DSA_HAMILTONIAN_SEARCH_H
+#define DSA_HAMILTONIAN_SEARCH_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "parallel.h"
+using namespace std;
+
+// Backtracking search for Hamiltonian cycles and paths in graphs of up
+// to 64 vertices, with the whole search state kept in bitmasks.
+//
+// Pruning:
+//  - bipartite parity: a bipartite graph only has a Hamiltonian cycle if
+//    both sides have the same size (a path allows a difference of one);
+//  - degree: after each move, every unvisited neighbor of the vertex just
+//    left must still have enough free neighbors to be entered and left.
+//
+// Threads share the tree with work stealing: a worker whose own queue
+// runs low pushes the sibling subtrees of its current node there, and idle
+// workers take the oldest (largest) subtrees from other queues.
+
+struct HamiltonianOptions {
+    bool cycle = true;         // close the tour back to the start vertex
+    bool stopAtFirst = false;  // stop after the first solution instead of counting all
+    unsigned numThreads = defaultThreadCount();
+};
+
+struct HamiltonianResult {
+    uint64_t solutions = 0;    // cycles start at vertex 0; both directions count
+    vector<int> firstSolution; // vertex order of one solution, empty if none
+    uint64_t nodes = 0;        // search tree nodes visited
+    double seconds = 0;
+    bool rejectedByParity = false;  // answered by the bipartite check alone
+
+    double nodesPerSecond() const { return seconds > 0 ? nodes / seconds : 0; }
+};
+
+class HamiltonianSearch {
+private:
+    static const int SPLIT_MIN_REMAINING = 8;  // don't share subtrees smaller than this
+
+    struct Task {
+        uint64_t visited;
+        int depth;
+        uint8_t path[64];
+    };
+
+    struct Worker {
+        mutex lock;
+        deque<Task> tasks;
+        atomic<size_t> queued{0};
+        uint64_t nodes = 0;
+        uint64_t solutions = 0;
+        uint8_t path[64];
+    };
+
+    int n;
+    vector<uint64_t> adj;  // adj[v] has bit w set if v -- w
+    uint64_t all;
+    HamiltonianOptions options;
+    int start = 0;
+    bool parallel = false;
+
+    vector<unique_ptr<Worker>> workers;
+    atomic<uint64_t> pending{0};  // tasks queued or running
+    atomic<bool> stop{false};
+    mutex solutionLock;
+    vector<int> firstSolution;
+
+    static uint64_t bit(int v) { return 1ULL << v; }
+
+    // Two-colors the graph; false if it is not bipartite
+    bool bipartiteSides(int& sideA, int& sideB) const {
+        vector<int> color(n, -1);
+        sideA = sideB = 0;
+        for (int s = 0; s < n; s++) {
+            if (color[s] != -1) continue;
+            vector<int> stack = {s};
+            color[s] = 0;
+            while (!stack.empty()) {
+                int v = stack.back();
+                stack.pop_back();
+                (color[v] == 0 ? sideA : sideB)++;
+                for (uint64_t m = adj[v]; m; m &= m - 1) {
+                    int w = __builtin_ctzll(m);
+                    if (color[w] == -1) {
+                        color[w] = 1 - color[v];
+                        stack.push_back(w);
+                    } else if (color[w] == color[v]) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    bool connected() const {
+        uint64_t seen = bit(0), frontier = bit(0);
+        while (frontier) {
+            uint64_t next = 0;
+            for (uint64_t m = frontier; m; m &= m - 1) next |= adj[__builtin_ctzll(m)];
+            frontier = next & ~seen;
+            seen |= next;
+        }
+        return seen == all;
+    }
+
+    // Degree pruning for the move cur -> next (visited already includes next)
+    bool feasible(int cur, int next, uint64_t visited) const {
+        uint64_t open = all & ~visited;
+        if (!open) return true;
+        if (options.cycle && !(adj[start] & open)) return false;
+
+        uint64_t ends = bit(next) | (options.cycle ? bit(start) : 0);
+        int need = options.cycle ? 2 : 1;
+        for (uint64_t m = adj[cur] & open; m; m &= m - 1) {
+            int w = __builtin_ctzll(m);
+            if (__builtin_popcountll(adj[w] & (open | ends)) < need) return false;
+        }
+        return true;
+    }
+
+    void push(Worker& w, const Task& task) {
+        pending++;
+        lock_guard<mutex> guard(w.lock);
+        w.tasks.push_back(task);
+        w.queued++;
+    }
+
+    bool popOwn(Worker& w, Task& task) {
+        lock_guard<mutex> guard(w.lock);
+        if (w.tasks.empty()) return false;
+        task = w.tasks.back();
+        w.tasks.pop_back();
+        w.queued--;
+        return true;
+    }
+
+    bool steal(unsigned self, Task& task) {
+        for (unsigned k = 1; k < workers.size(); k++) {
+            Worker& victim = *workers[(self + k) % workers.size()];
+            if (victim.queued == 0) continue;
+            lock_guard<mutex> guard(victim.lock);
+            if (victim.tasks.empty()) continue;
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            victim.queued--;
+            return true;
+        }
+        return false;
+    }
+
+    void found(Worker& w) {
+        w.solutions++;
+        if (options.stopAtFirst) stop = true;
+        lock_guard<mutex> guard(solutionLock);
+        if (firstSolution.empty()) firstSolution.assign(w.path, w.path + n);
+    }
+
+    void search(Worker& w, int cur, uint64_t visited, int depth) {
+        w.nodes++;
+        if (depth == n) {
+            if (!options.cycle || (adj[cur] & bit(start))) found(w);
+            return;
+        }
+        if (stop.load(memory_order_relaxed)) return;
+
+        // Feasible next vertices; for a first-solution search try the ones
+        // with the fewest onward choices first (Warnsdorff's rule)
+        int candidates[64];
+        int count = 0;
+        for (uint64_t m = adj[cur] & ~visited; m; m &= m - 1) {
+            int next = __builtin_ctzll(m);
+            if (feasible(cur, next, visited | bit(next))) candidates[count++] = next;
+        }
+        if (options.stopAtFirst) {
+            uint64_t after = ~visited;
+            sort(candidates, candidates + count, [&](int a, int b) {
+                return __builtin_popcountll(adj[a] & after) < __builtin_popcountll(adj[b] & after);
+            });
+        }
+
+        bool share = parallel && n - depth > SPLIT_MIN_REMAINING && w.queued < 2;
+        for (int i = 0; i < count; i++) {
+            int next = candidates[i];
+            w.path[depth] = next;
+            if (share && i + 1 < count) {
+                Task task;
+                task.visited = visited | bit(next);
+                task.depth = depth + 1;
+                copy(w.path, w.path + depth + 1, task.path);
+                push(w, task);
+                continue;
+            }
+            search(w, next, visited | bit(next), depth + 1);
+            if (stop.load(memory_order_relaxed)) return;
+        }
+    }
+
+    void runWorker(unsigned self) {
+        Worker& w = *workers[self];
+        Task task;
+        while (true) {
+            if (popOwn(w, task) || steal(self, task)) {
+                copy(task.path, task.path + task.depth, w.path);
+                search(w, task.path[task.depth - 1], task.visited, task.depth);
+                pending--;
+                continue;
+            }
+            if (pending == 0 || stop) return;
+            this_thread::yield();
+        }
+    }
+
+public:
+    // adjacency[v] is the neighbor bitmask of vertex v; at most 64 vertices
+    HamiltonianSearch(const vector<uint64_t>& adjacency) : n((int)adjacency.size()), adj(adjacency) {
+        all = n == 64 ? ~0ULL : bit(n) - 1;
+    }
+
+    HamiltonianResult run(const HamiltonianOptions& opts) {
+        options = opts;
+        HamiltonianResult result;
+        auto startTime = chrono::steady_clock::now();
+        if (n == 0) return result;
+
+        // Cheap structural checks before any search
+        int sideA, sideB;
+        if (bipartiteSides(sideA, sideB)) {
+            int diff = abs(sideA - sideB);
+            if ((options.cycle && diff != 0) || diff > 1) {
+                result.rejectedByParity = true;
+                return result;
+            }
+        }
+        if (!connected()) return result;
+        if (options.cycle && n < 3) return result;
+
+        unsigned numThreads = max(1u, options.numThreads);
+        parallel = numThreads > 1;
+        workers.clear();
+        for (unsigned t = 0; t < numThreads; t++) workers.emplace_back(new Worker());
+        pending = 0;
+        stop = false;
+        firstSolution.clear();
+
+        // Cycles all pass through vertex 0, so fixing it as the start
+        // removes the n rotations of every cycle. Paths may start anywhere.
+        int firstStart = 0, lastStart = options.cycle ? 0 : n - 1;
+        for (int s = firstStart; s <= lastStart; s++) {
+            Task task;
+            task.visited = bit(s);
+            task.depth = 1;
+            task.path[0] = (uint8_t)s;
+            push(*workers[s % numThreads], task);
+        }
+
+        if (parallel) {
+            vector<thread> threads;
+            for (unsigned t = 0; t < numThreads; t++) threads.emplace_back(&HamiltonianSearch::runWorker, this, t);
+            for (thread& th : threads) th.join();
+        } else {
+            runWorker(0);
+        }
+
+        for (auto& w : workers) {
+            result.nodes += w->nodes;
+            result.solutions += w->solutions;
+        }
+        if (options.stopAtFirst) {
+            result.solutions = min<uint64_t>(result.solutions, 1);  // others may finish at the same time
+        }
+        result.firstSolution = firstSolution;
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef DSA_LAZY_TRAVERSAL_H
+#define DSA_LAZY_TRAVERSAL_H
+
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include "graph_file.h"
+#include "graph_instrumentation.h"
+using namespace std;
+
+// BFS and DFS that hand out one vertex at a time, with its depth and its
+// parent in the traversal tree, instead of running to the end:
+//
+//   LazyBFS<CsrView> bfs(adj, start);
+//   for (const TraversalStep& step : bfs) {
+//       if (step.vertex == target) break;  // nothing past here is scanned
+//   }
+//
+// A row is scanned only when the caller asks for more vertices than have
+// been discovered so far, so stopping early leaves the rest of the graph
+// untouched; the queue and stack hold only vertices actually reached
+// (the visited bits are one per vertex). TraversalLimits adds a depth
+// limit and a flag another thread can set to cancel.
+//
+// Vertices come out in the same order as the full DFS and BFS of
+// question 2: BFS in order of discovery, DFS in preorder.
+
+struct TraversalStep {
+    uint32_t vertex;
+    uint32_t depth;   // tree edges from the start vertex
+    int64_t parent;   // -1 for the start vertex
+};
+
+struct TraversalLimits {
+    uint32_t maxDepth = UINT32_MAX;        // rows of vertices at this depth are not scanned
+    const atomic<bool>* cancel = nullptr;  // the traversal ends once this is set
+};
+
+// The graph types LazyBFS accepts: CsrView, or anything with
+// numVertices() and forEachNeighbor(u, f(v, weight)) (adaptive_graph.h,
+// compressed_adjacency.h)
+inline uint64_t vertexCountOf(const CsrView& g) { return g.numVertices; }
+template <class G>
+uint64_t vertexCountOf(const G& g) { return g.numVertices(); }
+
+template <class F>
+void forEachNeighborOf(const CsrView& g, uint32_t u, F f) {
+    for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) f(g.targets[e]);
+}
+template <class G, class F>
+void forEachNeighborOf(const G& g, uint32_t u, F f) {
+    g.forEachNeighbor(u, [&](uint32_t v, int) { f(v); });
+}
+
+// Range-for support: begin() fetches the first step, ++ the next one,
+// and the iterator equals end() once the traversal has finished
+template <class T>
+class TraversalIterator {
+private:
+    T* traversal;
+    TraversalStep step;
+
+public:
+    TraversalIterator(T* t) : traversal(t) {
+        if (traversal) ++*this;
+    }
+
+    const TraversalStep& operator*() const { return step; }
+    const TraversalStep* operator->() const { return &step; }
+
+    TraversalIterator& operator++() {
+        if (!traversal->next(step)) traversal = nullptr;
+        return *this;
+    }
+
+    bool operator!=(const TraversalIterator& other) const { return traversal != other.traversal; }
+};
+
+// G is copied: use a CsrView, or a reference type such as
+// const CompressedGraph& for graphs that must not be copied
+template <class G>
+class LazyBFS {
+private:
+    G graph;
+    TraversalLimits limits;
+    vector<bool> visited;
+    vector<TraversalStep> queue;  // every vertex discovered, in order
+    size_t handedOut = 0;         // queue[0, handedOut) went to the caller
+    size_t expanded = 0;          // queue[0, expanded) had their rows scanned
+    bool stopped = false;
+
+    bool cancelled() const { return limits.cancel && limits.cancel->load(memory_order_relaxed); }
+
+public:
+    LazyBFS(G g, uint32_t start, TraversalLimits traversalLimits = TraversalLimits())
+        : graph(g), limits(traversalLimits), visited(vertexCountOf(graph), false) {
+        visited[start] = true;
+        queue.push_back({start, 0, -1});
+    }
+
+    bool next(TraversalStep& step) {
+        if (stopped || cancelled()) return false;
+        // Scan rows of vertices already handed out until one finds
+        // something new (or the reachable part is exhausted)
+        while (handedOut == queue.size() && expanded < handedOut) {
+            TraversalStep from = queue[expanded++];
+            if (from.depth >= limits.maxDepth) continue;
+            INSTRUMENT_COUNT(verticesVisited, 1);
+            forEachNeighborOf(graph, from.vertex, [&](uint32_t v) {
+                INSTRUMENT_COUNT(edgesScanned, 1);
+                if (!visited[v]) {
+                    visited[v] = true;
+                    queue.push_back({v, from.depth + 1, (int64_t)from.vertex});
+                }
+            });
+        }
+        if (handedOut == queue.size()) return false;
+        step = queue[handedOut++];
+        return true;
+    }
+
+    void stop() { stopped = true; }
+
+    TraversalIterator<LazyBFS> begin() { return TraversalIterator<LazyBFS>(this); }
+    TraversalIterator<LazyBFS> end() { return TraversalIterator<LazyBFS>(nullptr); }
+};
+
+// DFS needs to resume in the middle of a row, so it walks CSR arrays.
+// With a depth limit a vertex is visited at most once, by the first path
+// found, so a vertex first reached by a long path is not reached again by
+// a shorter one (as in any depth-limited DFS with visited marks).
+class LazyDFS {
+private:
+    struct Frame {
+        uint32_t vertex;
+        uint32_t depth;
+        uint64_t nextEdge;
+    };
+
+    CsrView graph;
+    TraversalLimits limits;
+    vector<bool> visited;
+    vector<Frame> stack;
+    TraversalStep pending;  // the start vertex, until it is handed out
+    bool startPending = true;
+    bool stopped = false;
+
+    bool cancelled() const { return limits.cancel && limits.cancel->load(memory_order_relaxed); }
+
+    // Rows of vertices at the depth limit are never scanned
+    void enter(uint32_t v, uint32_t depth) {
+        INSTRUMENT_COUNT(verticesVisited, 1);
+        if (depth < limits.maxDepth) stack.push_back({v, depth, graph.offsets[v]});
+    }
+
+public:
+    LazyDFS(const CsrView& g, uint32_t start, TraversalLimits traversalLimits = TraversalLimits())
+        : graph(g), limits(traversalLimits), visited(g.numVertices, false) {
+        visited[start] = true;
+        pending = {start, 0, -1};
+    }
+
+    bool next(TraversalStep& step) {
+        if (stopped || cancelled()) return false;
+        if (startPending) {
+            startPending = false;
+            enter(pending.vertex, 0);
+            step = pending;
+            return true;
+        }
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.nextEdge == graph.offsets[top.vertex + 1]) {
+                stack.pop_back();  // Backtrack
+                continue;
+            }
+            uint32_t v = graph.targets[top.nextEdge++];
+            INSTRUMENT_COUNT(edgesScanned, 1);
+            if (!visited[v]) {
+                visited[v] = true;
+                step = {v, top.depth + 1, (int64_t)top.vertex};
+                enter(v, step.depth);  // may reallocate the stack, so `top` is not used after
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void stop() { stopped = true; }
+
+    TraversalIterator<LazyDFS> begin() { return TraversalIterator<LazyDFS>(this); }
+    TraversalIterator<LazyDFS> end() { return TraversalIterator<LazyDFS>(nullptr); }
+};
+
+// Runs `traversal` until a vertex satisfies `target` and returns the tree
+// path to it (start first), or an empty path if none is reached. Parents
+// are kept only for the vertices handed out.
+template <class T, class P>
+vector<uint32_t> findPath(T& traversal, P target, uint64_t* reached = nullptr) {
+    unordered_map<uint32_t, int64_t> parents;
+    vector<uint32_t> path;
+    for (const TraversalStep& step : traversal) {
+        parents[step.vertex] = step.parent;
+        if (!target(step.vertex)) continue;
+        for (int64_t v = step.vertex; v >= 0; v = parents[(uint32_t)v]) path.push_back((uint32_t)v);
+        reverse(path.begin(), path.end());
+        break;
+    }
+    if (reached) *reached = parents.size();
+    return path;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef DSA_PARALLEL_H
+#define DSA_PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+// Small std::thread helpers shared by the parallel graph code.
+
+inline unsigned defaultThreadCount() {
+    unsigned n = thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Splits [0, n) into one contiguous chunk per thread and calls
+// f(threadIndex, begin, end). Chunks are in order: thread t gets the t-th.
+template <class F>
+void parallelForChunks(uint64_t n, unsigned numThreads, F f) {
+    if (numThreads <= 1 || n < 2) {
+        f(0u, (uint64_t)0, n);
+        return;
+    }
+    numThreads = (unsigned)min<uint64_t>(numThreads, n);
+    vector<thread> workers;
+    for (unsigned t = 0; t < numThreads; t++) {
+        uint64_t begin = n * t / numThreads;
+        uint64_t end = n * (t + 1) / numThreads;
+        workers.emplace_back([=, &f] { f(t, begin, end); });
+    }
+    for (thread& w : workers) w.join();
+}
+
+// Hands out items 0..n-1 one at a time from a shared counter and calls
+// f(threadIndex, item). Good for items of very uneven cost.
+template <class F>
+void parallelForDynamic(uint64_t n, unsigned numThreads, F f) {
+    atomic<uint64_t> next(0);
+    auto worker = [&](unsigned t) {
+        for (uint64_t i = next++; i < n; i = next++) f(t, i);
+    };
+    if (numThreads <= 1) {
+        worker(0);
+        return;
+    }
+    vector<thread> workers;
+    for (unsigned t = 0; t < numThreads; t++) workers.emplace_back(worker, t);
+    for (thread& w : workers) w.join();
+}
+
+#endif
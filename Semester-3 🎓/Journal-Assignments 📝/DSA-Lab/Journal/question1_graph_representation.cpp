@@ -1,70 +1,75 @@
 #include <iostream>
 #include <vector>
-#include <map>
+#include <string>
+#include <chrono>
+#include "graph_store.h"
+#include "adaptive_graph.h"
 using namespace std;
 
 // Question 1: Graph Representation using Adjacency Matrix and Adjacency List
 
+const int MAX_MATRIX_VERTICES = 32;  // Larger graphs are only shown as lists
+
 class Graph {
 private:
-    int numVertices;
-    map<char, int> vertexIndex;  // Map vertex names to indices
-    map<int, char> indexVertex;  // Map indices to vertex names
+    GraphStore graph;  // Vertex labels plus CSR edges over dense indices
+    
+    string vertexName(uint32_t index) { return graph.vertexName(index); }
     
 public:
     Graph() {
-        numVertices = 5;
         // Map vertices A, B, C, D, E to indices 0, 1, 2, 3, 4
-        vertexIndex['A'] = 0;
-        vertexIndex['B'] = 1;
-        vertexIndex['C'] = 2;
-        vertexIndex['D'] = 3;
-        vertexIndex['E'] = 4;
+        graph.addVertex("A");
+        graph.addVertex("B");
+        graph.addVertex("C");
+        graph.addVertex("D");
+        graph.addVertex("E");
         
-        indexVertex[0] = 'A';
-        indexVertex[1] = 'B';
-        indexVertex[2] = 'C';
-        indexVertex[3] = 'D';
-        indexVertex[4] = 'E';
+        // Graph edges from the diagram
+        addEdge("A", "B", 5);
+        addEdge("A", "D", 10);
+        addEdge("A", "E", 6);
+        addEdge("B", "D", 3);
+        addEdge("D", "D", 0);  // Self-loop
+        addEdge("D", "C", 4);
+        addEdge("E", "C", 4);
+    }
+    
+    void addEdge(const string& from, const string& to, int weight) {
+        graph.addEdge(from, to, weight);
+    }
+    
+    // Replace the example graph with a graph file (see graph_file.h)
+    bool loadFromFile(const string& path) {
+        return graph.loadFromFile(path);
     }
     
     // Adjacency Matrix Representation
     void displayAdjacencyMatrix() {
+        int numVertices = (int)graph.vertexCount();
         cout << "\n=== ADJACENCY MATRIX ===" << endl;
+        if (numVertices > MAX_MATRIX_VERTICES) {
+            cout << "Graph has " << numVertices << " vertices, too many to print as a matrix" << endl;
+            return;
+        }
         cout << "Rows represent source vertices, columns represent destination vertices" << endl;
         cout << "Values represent edge weights (0 means no edge)\n" << endl;
         
-        // Initialize matrix with 0s
-        int adjMatrix[5][5] = {0};
-        
-        // Fill the matrix based on the graph edges
-        // A → B (weight 5)
-        adjMatrix[vertexIndex['A']][vertexIndex['B']] = 5;
-        // A → D (weight 10)
-        adjMatrix[vertexIndex['A']][vertexIndex['D']] = 10;
-        // A → E (weight 6)
-        adjMatrix[vertexIndex['A']][vertexIndex['E']] = 6;
-        // B → D (weight 3)
-        adjMatrix[vertexIndex['B']][vertexIndex['D']] = 3;
-        // D → D (weight 0, self-loop)
-        adjMatrix[vertexIndex['D']][vertexIndex['D']] = 0;
-        // D → C (weight 4)
-        adjMatrix[vertexIndex['D']][vertexIndex['C']] = 4;
-        // E → C (weight 4)
-        adjMatrix[vertexIndex['E']][vertexIndex['C']] = 4;
+        // Bit matrix plus weight matrix, converted from the CSR edges
+        DenseGraph adjMatrix = DenseGraph::fromCsr(graph.edges());
         
         // Display matrix with headers
         cout << "     ";
         for (int i = 0; i < numVertices; i++) {
-            cout << indexVertex[i] << "   ";
+            cout << vertexName(i) << "   ";
         }
         cout << endl;
         cout << "   ----------------" << endl;
         
         for (int i = 0; i < numVertices; i++) {
-            cout << indexVertex[i] << " | ";
+            cout << vertexName(i) << " | ";
             for (int j = 0; j < numVertices; j++) {
-                cout << adjMatrix[i][j] << "   ";
+                cout << adjMatrix.weight(i, j) << "   ";
             }
             cout << endl;
         }
@@ -72,37 +77,20 @@ public:
     
     // Adjacency List Representation
     void displayAdjacencyList() {
+        int numVertices = (int)graph.vertexCount();
         cout << "\n=== ADJACENCY LIST ===" << endl;
         cout << "Each vertex shows its adjacent vertices with edge weights\n" << endl;
         
-        // Create adjacency list using vector of pairs (destination, weight)
-        vector<pair<char, int>> adjList[5];
-        
-        // Add edges to adjacency list
-        // A → B (5), A → D (10), A → E (6)
-        adjList[vertexIndex['A']].push_back({'B', 5});
-        adjList[vertexIndex['A']].push_back({'D', 10});
-        adjList[vertexIndex['A']].push_back({'E', 6});
-        
-        // B → D (3)
-        adjList[vertexIndex['B']].push_back({'D', 3});
-        
-        // D → D (0), D → C (4)
-        adjList[vertexIndex['D']].push_back({'D', 0});
-        adjList[vertexIndex['D']].push_back({'C', 4});
-        
-        // E → C (4)
-        adjList[vertexIndex['E']].push_back({'C', 4});
-        
-        // Display adjacency list
+        // Display adjacency list straight from the CSR arrays
+        CsrView adj = graph.edges();
         for (int i = 0; i < numVertices; i++) {
-            cout << indexVertex[i] << " -> ";
-            if (adjList[i].empty()) {
+            cout << vertexName(i) << " -> ";
+            if (adj.degree(i) == 0) {
                 cout << "NULL";
             } else {
-                for (size_t j = 0; j < adjList[i].size(); j++) {
-                    cout << adjList[i][j].first << "(" << adjList[i][j].second << ")";
-                    if (j < adjList[i].size() - 1) {
+                for (uint64_t e = adj.offsets[i]; e < adj.offsets[i + 1]; e++) {
+                    cout << vertexName(adj.targets[e]) << "(" << adj.weight(e) << ")";
+                    if (e < adj.offsets[i + 1] - 1) {
                         cout << " -> ";
                     }
                 }
@@ -111,27 +99,102 @@ public:
         }
     }
     
+    // Which representation AdaptiveGraph picks for this graph, and the
+    // result of kernels compiled for that representation
+    void displayRepresentation() {
+        CsrView adj = graph.edges();
+        uint64_t n = adj.numVertices, m = adj.numEdges;
+        bool weighted = adj.weights != nullptr;
+        bool sorted = graph.isLoaded() && graph.loadedFile().isSorted();
+        
+        cout << "\n=== REPRESENTATION CHOICE ===" << endl;
+        cout << "Vertices: " << n << ", edges: " << m
+             << ", density: " << AdaptiveGraph::density(n, m) << endl;
+        cout << "Dense matrix: " << DenseGraph::bytesFor(n, weighted) << " bytes, sparse CSR: "
+             << SparseGraph::bytesFor(n, m, weighted) << " bytes" << endl;
+        
+        auto startTime = chrono::steady_clock::now();
+        AdaptiveGraph g;
+        g.assign(adj, sorted);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        const char* kindName = g.kind() == AdaptiveGraph::DENSE ? "dense matrix" : "sparse CSR";
+        cout << "Chosen: " << kindName << endl;
+        if (n == 0) return;
+        
+        // Each kernel is instantiated for the representation held
+        vector<uint32_t> degrees = g.dispatch([](const auto& rep) { return outDegrees(rep); });
+        vector<int> levels = g.dispatch([](const auto& rep) { return bfsLevels(rep, 0); });
+        
+        if ((int)n <= MAX_MATRIX_VERTICES) {
+            cout << "Out-degrees: ";
+            for (uint64_t i = 0; i < n; i++) {
+                cout << vertexName(i) << "=" << degrees[i] << (i + 1 < n ? ", " : "\n");
+            }
+            cout << "BFS levels from " << vertexName(0) << ": ";
+            for (uint64_t i = 0; i < n; i++) {
+                cout << vertexName(i) << "=";
+                if (levels[i] < 0) cout << "-";
+                else cout << levels[i];
+                cout << (i + 1 < n ? ", " : "\n");
+            }
+            return;
+        }
+        
+        // Large graphs: summaries, and how long the conversions take
+        uint64_t reached = 0;
+        int depth = 0;
+        for (int level : levels) {
+            if (level >= 0) reached++;
+            depth = max(depth, level);
+        }
+        cout << "Max out-degree: " << *max_element(degrees.begin(), degrees.end()) << endl;
+        cout << "BFS from " << vertexName(0) << ": " << reached << " vertices reached, "
+             << depth << " levels" << endl;
+        cout << "Building the " << kindName << ": " << seconds << " s" << endl;
+        if (DenseGraph::bytesFor(n, weighted) <= AdaptiveGraph::DENSE_MAX_BYTES) {
+            AdaptiveGraph::Kind other = g.kind() == AdaptiveGraph::DENSE ? AdaptiveGraph::SPARSE : AdaptiveGraph::DENSE;
+            startTime = chrono::steady_clock::now();
+            g.convertTo(other);
+            seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+            cout << "Converting to " << (other == AdaptiveGraph::DENSE ? "dense matrix" : "sparse CSR")
+                 << ": " << seconds << " s" << endl;
+        }
+    }
+    
     void displayGraphInfo() {
         cout << "\n===============================================" << endl;
         cout << "        GRAPH REPRESENTATION" << endl;
         cout << "===============================================" << endl;
+        if (graph.isLoaded()) {
+            cout << "\nGraph loaded from file: " << graph.vertexCount() << " vertices, "
+                 << graph.edgeCount() << " edges" << endl;
+            return;
+        }
         cout << "\nGraph Edges (from the diagram):" << endl;
-        cout << "  A → B (weight: 5)" << endl;
-        cout << "  A → D (weight: 10)" << endl;
-        cout << "  A → E (weight: 6)" << endl;
-        cout << "  B → D (weight: 3)" << endl;
-        cout << "  D → D (weight: 0, self-loop)" << endl;
-        cout << "  D → C (weight: 4)" << endl;
-        cout << "  E → C (weight: 4)" << endl;
+        CsrView adj = graph.edges();
+        for (int i = 0; i < (int)adj.numVertices; i++) {
+            for (uint64_t e = adj.offsets[i]; e < adj.offsets[i + 1]; e++) {
+                cout << "  " << vertexName(i) << " → " << vertexName(adj.targets[e])
+                     << " (weight: " << adj.weight(e);
+                if ((int)adj.targets[e] == i) cout << ", self-loop";
+                cout << ")" << endl;
+            }
+        }
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
     Graph g;
     
+    // Optional: ./question1 graph.dsag
+    if (argc > 1 && !g.loadFromFile(argv[1])) {
+        return 1;
+    }
+    
     g.displayGraphInfo();
     g.displayAdjacencyMatrix();
     g.displayAdjacencyList();
+    g.displayRepresentation();
     
     cout << "\n===============================================" << endl;
     
@@ -1,87 +1,121 @@
 #include <iostream>
 #include <vector>
-#include <queue>
-#include <stack>
-#include <map>
-#include <set>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include "graph_store.h"
+#include "result_sink.h"
+#include "lazy_traversal.h"
+#include "betweenness.h"
+#include "graph_instrumentation.h"
 using namespace std;
 
 // Question 2: Depth-First Search (DFS) and Breadth-First Search (BFS) Traversal
 
 class GraphTraversal {
 private:
-    int numVertices;
-    map<char, int> vertexIndex;
-    map<int, char> indexVertex;
-    vector<pair<char, int>> adjList[5];  // Adjacency list
+    GraphStore graph;  // Vertex labels plus CSR adjacency over dense indices
+    
+    string vertexName(uint32_t index) { return graph.vertexName(index); }
+    CsrView edges() { return graph.edges(); }
     
 public:
     GraphTraversal() {
-        numVertices = 5;
-        
         // Map vertices to indices
-        vertexIndex['A'] = 0;
-        vertexIndex['B'] = 1;
-        vertexIndex['C'] = 2;
-        vertexIndex['D'] = 3;
-        vertexIndex['E'] = 4;
-        
-        indexVertex[0] = 'A';
-        indexVertex[1] = 'B';
-        indexVertex[2] = 'C';
-        indexVertex[3] = 'D';
-        indexVertex[4] = 'E';
+        graph.addVertex("A");
+        graph.addVertex("B");
+        graph.addVertex("C");
+        graph.addVertex("D");
+        graph.addVertex("E");
         
         // Build adjacency list from the graph
-        addEdge('A', 'B', 5);
-        addEdge('A', 'D', 10);
-        addEdge('A', 'E', 6);
-        addEdge('B', 'D', 3);
-        addEdge('D', 'D', 0);  // Self-loop
-        addEdge('D', 'C', 4);
-        addEdge('E', 'C', 4);
+        addEdge("A", "B", 5);
+        addEdge("A", "D", 10);
+        addEdge("A", "E", 6);
+        addEdge("B", "D", 3);
+        addEdge("D", "D", 0);  // Self-loop
+        addEdge("D", "C", 4);
+        addEdge("E", "C", 4);
+    }
+    
+    void addEdge(const string& from, const string& to, int weight) {
+        graph.addEdge(from, to, weight);
+    }
+    
+    // Replace the example graph with a graph file (see graph_file.h)
+    bool loadFromFile(const string& path) {
+        return graph.loadFromFile(path);
     }
     
-    void addEdge(char from, char to, int weight) {
-        int fromIndex = vertexIndex[from];
-        adjList[fromIndex].push_back({to, weight});
+    // Dense index of a vertex label (or number, for unlabeled files), -1 if unknown
+    int64_t findVertex(const string& label) { return graph.findVertex(label); }
+    
+    // Dense index of the input's first vertex, wherever reorder() moved it
+    int64_t firstVertex() { return graph.currentIndex(0); }
+    
+    // Relabel the vertices for cache locality before running anything
+    // (see vertex_ordering.h); openOutput() sinks undo it on output
+    void reorder(VertexOrder order, unsigned numThreads = defaultThreadCount()) {
+        graph.reorder(order, numThreads);
     }
     
-    // Depth-First Search (DFS) using recursion
-    void DFSUtil(int vertex, vector<bool>& visited, vector<char>& traversal) {
+    // Sink for results from a command line spec, in the input's numbering
+    unique_ptr<ResultSink> openOutput(const string& spec) { return graph.openOutput(spec); }
+    
+    // Depth-First Search (DFS) with an explicit stack instead of recursion,
+    // so large loaded graphs cannot overflow the call stack. Each stack
+    // entry remembers the next edge to try, which gives the same visiting
+    // order as the recursive version.
+    // Vertices are sent to `out` in the order they are visited.
+    void DFSUtil(int vertex, vector<bool>& visited, ResultSink& out) {
+        CsrView adj = edges();
+        vector<pair<uint32_t, uint64_t>> stack;  // (vertex, next edge)
+        
         visited[vertex] = true;
-        traversal.push_back(indexVertex[vertex]);
+        out.listVertex(vertex);
+        INSTRUMENT_COUNT(verticesVisited, 1);
+        stack.push_back({(uint32_t)vertex, adj.offsets[vertex]});
         
-        // Visit all adjacent vertices
-        for (auto& neighbor : adjList[vertex]) {
-            char neighborVertex = neighbor.first;
-            int neighborIndex = vertexIndex[neighborVertex];
+        while (!stack.empty()) {
+            uint32_t current = stack.back().first;
+            uint64_t& nextEdge = stack.back().second;
+            
+            // Visit the next unvisited adjacent vertex
+            if (nextEdge == adj.offsets[current + 1]) {
+                stack.pop_back();  // Backtrack
+                continue;
+            }
+            uint32_t neighborIndex = adj.targets[nextEdge++];
+            INSTRUMENT_COUNT(edgesScanned, 1);
             
             if (!visited[neighborIndex]) {
-                DFSUtil(neighborIndex, visited, traversal);
+                visited[neighborIndex] = true;
+                out.listVertex(neighborIndex);
+                INSTRUMENT_COUNT(verticesVisited, 1);
+                stack.push_back({neighborIndex, adj.offsets[neighborIndex]});
             }
         }
     }
     
-    void DFS(char startVertex) {
-        cout << "\n=== DEPTH-FIRST SEARCH (DFS) ===" << endl;
-        cout << "Starting from vertex: " << startVertex << "\n" << endl;
+    void DFS(int startIndex, ResultSink& out) {
+        INSTRUMENT_SCOPE("dfs");
+        vector<bool> visited(graph.vertexCount(), false);
         
-        vector<bool> visited(numVertices, false);
-        vector<char> traversal;
-        
-        int startIndex = vertexIndex[startVertex];
-        DFSUtil(startIndex, visited, traversal);
+        out.beginList("DFS Traversal Order");
+        DFSUtil(startIndex, visited, out);
+        out.endList();
+    }
+    
+    void DFS(int startIndex) {
+        cout << "\n=== DEPTH-FIRST SEARCH (DFS) ===" << endl;
+        cout << "Starting from vertex: " << vertexName(startIndex) << "\n" << endl;
         
         // Print DFS traversal
-        cout << "DFS Traversal Order: ";
-        for (size_t i = 0; i < traversal.size(); i++) {
-            cout << traversal[i];
-            if (i < traversal.size() - 1) {
-                cout << " -> ";
-            }
-        }
-        cout << endl;
+        TextSink out(stdout, [this](uint32_t v) { return vertexName(v); });
+        DFS(startIndex, out);
+        if (graph.isLoaded()) return;
         
         // Explanation
         cout << "\nExplanation:" << endl;
@@ -93,46 +127,50 @@ public:
         cout << "- All vertices visited, DFS complete" << endl;
     }
     
-    // Breadth-First Search (BFS) using queue
-    void BFS(char startVertex) {
-        cout << "\n=== BREADTH-FIRST SEARCH (BFS) ===" << endl;
-        cout << "Starting from vertex: " << startVertex << "\n" << endl;
-        
-        vector<bool> visited(numVertices, false);
-        vector<char> traversal;
-        queue<int> q;
+    // Breadth-First Search (BFS) using queue. The queue is a plain array
+    // read from the front: every vertex enters it once, so it never wraps.
+    void BFS(int startIndex, ResultSink& out) {
+        INSTRUMENT_SCOPE("bfs");
+        CsrView adj = edges();
+        vector<bool> visited(graph.vertexCount(), false);
+        vector<uint32_t> q;
+        size_t head = 0;
+        FrontierCounter frontier;  // level sizes, only with DSA_INSTRUMENT
         
-        int startIndex = vertexIndex[startVertex];
+        out.beginList("BFS Traversal Order");
         visited[startIndex] = true;
-        q.push(startIndex);
-        traversal.push_back(indexVertex[startIndex]);
+        q.push_back(startIndex);
+        out.listVertex(startIndex);
         
-        while (!q.empty()) {
-            int current = q.front();
-            q.pop();
+        while (head < q.size()) {
+            frontier.next(head, q.size());
+            uint32_t current = q[head++];
+            INSTRUMENT_COUNT(verticesVisited, 1);
+            INSTRUMENT_COUNT(edgesScanned, adj.degree(current));
             
             // Visit all adjacent vertices
-            for (auto& neighbor : adjList[current]) {
-                char neighborVertex = neighbor.first;
-                int neighborIndex = vertexIndex[neighborVertex];
+            for (uint64_t e = adj.offsets[current]; e < adj.offsets[current + 1]; e++) {
+                uint32_t neighborIndex = adj.targets[e];
                 
                 if (!visited[neighborIndex]) {
                     visited[neighborIndex] = true;
-                    q.push(neighborIndex);
-                    traversal.push_back(neighborVertex);
+                    q.push_back(neighborIndex);
+                    out.listVertex(neighborIndex);
                 }
             }
         }
+        frontier.finish(q.size());
+        out.endList();
+    }
+    
+    void BFS(int startIndex) {
+        cout << "\n=== BREADTH-FIRST SEARCH (BFS) ===" << endl;
+        cout << "Starting from vertex: " << vertexName(startIndex) << "\n" << endl;
         
         // Print BFS traversal
-        cout << "BFS Traversal Order: ";
-        for (size_t i = 0; i < traversal.size(); i++) {
-            cout << traversal[i];
-            if (i < traversal.size() - 1) {
-                cout << " -> ";
-            }
-        }
-        cout << endl;
+        TextSink out(stdout, [this](uint32_t v) { return vertexName(v); });
+        BFS(startIndex, out);
+        if (graph.isLoaded()) return;
         
         // Explanation
         cout << "\nExplanation:" << endl;
@@ -145,10 +183,90 @@ public:
         cout << "- Queue empty, BFS complete" << endl;
     }
     
+    void DFS(const string& startVertex) { DFS((int)findVertex(startVertex)); }
+    void BFS(const string& startVertex) { BFS((int)findVertex(startVertex)); }
+    
+    // Lazy versions (lazy_traversal.h): vertices come out one at a time
+    // with depth and parent, and nothing is scanned past what is read
+    LazyDFS dfsSteps(int startIndex, TraversalLimits limits = TraversalLimits()) {
+        return LazyDFS(edges(), startIndex, limits);
+    }
+    
+    LazyBFS<CsrView> bfsSteps(int startIndex, TraversalLimits limits = TraversalLimits()) {
+        return LazyBFS<CsrView>(edges(), startIndex, limits);
+    }
+    
+    // Shortest path (in edges) by a BFS that stops at the target
+    vector<uint32_t> findPath(int startIndex, int targetIndex, TraversalLimits limits, uint64_t* reached = nullptr) {
+        LazyBFS<CsrView> bfs = bfsSteps(startIndex, limits);
+        return ::findPath(bfs, [targetIndex](uint32_t v) { return v == (uint32_t)targetIndex; }, reached);
+    }
+    
+    void displayLazyTraversal(const string& startVertex, const string& targetVertex) {
+        int start = (int)findVertex(startVertex);
+        int target = (int)findVertex(targetVertex);
+        cout << "\n=== LAZY TRAVERSAL ===" << endl;
+        
+        cout << "BFS from " << startVertex << ", stopping at " << targetVertex << ":" << endl;
+        for (const TraversalStep& step : bfsSteps(start)) {
+            cout << "  " << vertexName(step.vertex) << " (depth " << step.depth;
+            if (step.parent >= 0) cout << ", from " << vertexName((uint32_t)step.parent);
+            cout << ")" << endl;
+            if (step.vertex == (uint32_t)target) break;
+        }
+        
+        cout << "Path:";
+        vector<uint32_t> path = findPath(start, target, TraversalLimits());
+        for (size_t i = 0; i < path.size(); i++) {
+            cout << (i ? " -> " : " ") << vertexName(path[i]);
+        }
+        cout << endl;
+        
+        TraversalLimits shallow;
+        shallow.maxDepth = 1;
+        cout << "DFS from " << startVertex << ", depth limit 1:";
+        for (const TraversalStep& step : dfsSteps(start, shallow)) {
+            cout << " " << vertexName(step.vertex);
+        }
+        cout << endl;
+    }
+    
+    // Betweenness centrality of every vertex by Brandes' algorithm on
+    // BFS, so paths are counted in edges and weights are ignored
+    // (betweenness.h). Sources run in parallel, or a sample of them when
+    // options.epsilon is set.
+    BetweennessResult betweenness(BetweennessOptions options = BetweennessOptions()) {
+        INSTRUMENT_SCOPE("betweenness");
+        options.weighted = false;
+        options.undirected = graph.isLoaded() && graph.loadedFile().isUndirected();
+        return betweennessCentrality(edges(), options);
+    }
+    
+    void displayBetweenness() {
+        cout << "\n=== BETWEENNESS CENTRALITY (BFS) ===" << endl;
+        BetweennessResult result = betweenness();
+        for (uint32_t v = 0; v < result.centrality.size(); v++) {
+            cout << "  " << vertexName(v) << ": " << result.centrality[v] << endl;
+        }
+        cout << "\nExplanation:" << endl;
+        cout << "- A reaches C by two shortest paths, A-D-C and A-E-C: D and E get 1/2 each" << endl;
+        cout << "- B reaches C only through D: D gets 1 more" << endl;
+    }
+    
+    // Labels for output, e.g. to build a sink with openResultSink()
+    function<string(uint32_t)> names() {
+        return [this](uint32_t v) { return vertexName(v); };
+    }
+    
     void displayGraphInfo() {
         cout << "\n===============================================" << endl;
         cout << "        GRAPH TRAVERSAL ALGORITHMS" << endl;
         cout << "===============================================" << endl;
+        if (graph.isLoaded()) {
+            cout << "\nGraph loaded from file: " << graph.vertexCount() << " vertices, "
+                 << graph.edgeCount() << " edges" << endl;
+            return;
+        }
         cout << "\nGraph Structure:" << endl;
         cout << "  Vertices: A, B, C, D, E" << endl;
         cout << "  Edges: A→B(5), A→D(10), A→E(6), B→D(3)," << endl;
@@ -156,16 +274,132 @@ public:
     }
 };
 
-int main() {
+// graph_benchmark.cpp includes this file with DSA_JOURNAL_NO_MAIN defined
+#ifndef DSA_JOURNAL_NO_MAIN
+int main(int argc, char** argv) {
     GraphTraversal g;
     
+    // Optional: ./question2 graph.dsag [start vertex] [output] [--order NAME]
+    // where output is -, text:PATH, binary:PATH or null (see result_sink.h)
+    // and NAME a vertex order for locality (see vertex_ordering.h)
+    VertexOrder order;
+    if (!takeOrderOption(argc, argv, order)) {
+        return 1;
+    }
+    
+    // ./question2 --betweenness graph.dsag [threads] [EPSILON]
+    // prints the 10 most central vertices; EPSILON > 0 samples sources
+    if (argc > 1 && string(argv[1]) == "--betweenness") {
+        if (argc < 3) {
+            cout << "Usage: " << argv[0] << " --betweenness graph.dsag [threads] [EPSILON]" << endl;
+            return 1;
+        }
+        if (!g.loadFromFile(argv[2])) {
+            return 1;
+        }
+        if (order != ORDER_ORIGINAL) g.reorder(order);
+        BetweennessOptions options;
+        if (argc > 3) options.numThreads = (unsigned)max(1, atoi(argv[3]));
+        if (argc > 4) options.epsilon = atof(argv[4]);
+        
+        auto begin = chrono::steady_clock::now();
+        BetweennessResult result = g.betweenness(options);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        for (uint32_t v : mostCentral(result.centrality, 10)) {
+            cout << g.names()(v) << " " << result.centrality[v] << endl;
+        }
+        cerr << "Betweenness: " << result.sources << (result.sampled ? " sampled" : "") << " sources in "
+             << seconds << " s" << endl;
+#ifdef DSA_INSTRUMENT
+        instrumentReport(cerr);
+#endif
+        return 0;
+    }
+    
+    // ./question2 --search graph.dsag START TARGET [MAX_DEPTH]
+    // prints a fewest-edges path, scanning only as much of the graph as needed
+    if (argc > 1 && string(argv[1]) == "--search") {
+        if (argc < 5) {
+            cout << "Usage: " << argv[0] << " --search graph.dsag START TARGET [MAX_DEPTH]" << endl;
+            return 1;
+        }
+        if (!g.loadFromFile(argv[2])) {
+            return 1;
+        }
+        if (order != ORDER_ORIGINAL) g.reorder(order);
+        int64_t start = g.findVertex(argv[3]);
+        int64_t target = g.findVertex(argv[4]);
+        if (start < 0 || target < 0) {
+            cout << "Error: Node '" << argv[start < 0 ? 3 : 4] << "' does not exist in graph!" << endl;
+            return 1;
+        }
+        TraversalLimits limits;
+        if (argc > 5) limits.maxDepth = (uint32_t)max(0, atoi(argv[5]));
+        
+        auto begin = chrono::steady_clock::now();
+        uint64_t reached = 0;
+        vector<uint32_t> path = g.findPath((int)start, (int)target, limits, &reached);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        if (path.empty()) {
+            cout << "No path from " << argv[3] << " to " << argv[4] << endl;
+        } else {
+            for (size_t i = 0; i < path.size(); i++) {
+                cout << (i ? " -> " : "") << g.names()(path[i]);
+            }
+            cout << endl;
+        }
+        cerr << "Search: " << reached << " vertices reached in " << seconds << " s" << endl;
+        return path.empty() ? 1 : 0;
+    }
+    if (argc > 1) {
+        if (!g.loadFromFile(argv[1])) {
+            return 1;
+        }
+        if (order != ORDER_ORIGINAL) {
+            auto begin = chrono::steady_clock::now();
+            g.reorder(order);
+            cerr << "Reorder (" << vertexOrderName(order) << "): "
+                 << chrono::duration<double>(chrono::steady_clock::now() - begin).count() << " s" << endl;
+        }
+        int64_t start = argc > 2 ? g.findVertex(argv[2]) : g.firstVertex();
+        if (start < 0) {
+            cout << "Error: Node '" << argv[2] << "' does not exist in graph!" << endl;
+            return 1;
+        }
+        unique_ptr<ResultSink> out = g.openOutput(argc > 3 ? argv[3] : "-");
+        if (!out) {
+            return 1;
+        }
+        
+        // Timings go to stderr so they never mix with the results
+        auto timed = [&](const char* name, function<void()> run) {
+            auto begin = chrono::steady_clock::now();
+            run();
+            out->flush();
+            cerr << name << ": " << chrono::duration<double>(chrono::steady_clock::now() - begin).count()
+                 << " s" << endl;
+        };
+        timed("DFS", [&] { g.DFS((int)start, *out); });
+        timed("BFS", [&] { g.BFS((int)start, *out); });
+#ifdef DSA_INSTRUMENT
+        instrumentReport(cerr);
+#endif
+        return 0;
+    }
+    
     g.displayGraphInfo();
     
     // Perform DFS starting from vertex A
-    g.DFS('A');
+    g.DFS("A");
     
     // Perform BFS starting from vertex A
-    g.BFS('A');
+    g.BFS("A");
+    
+    // Stop early: search for C, and DFS only one edge deep
+    g.displayLazyTraversal("A", "C");
+    
+    // Which vertices the shortest paths run through
+    g.displayBetweenness();
     
     cout << "\n===============================================" << endl;
     cout << "\nKey Differences:" << endl;
@@ -177,3 +411,4 @@ int main() {
     
     return 0;
 }
+#endif
@@ -1,8 +1,12 @@
 #include <iostream>
 #include <vector>
-#include <map>
 #include <set>
 #include <algorithm>
+#include <string>
+#include <cstdlib>
+#include "graph_store.h"
+#include "graph_instrumentation.h"
+#include "clique_counting.h"
 using namespace std;
 
 // Question: Clique Detection in a Graph
@@ -10,30 +14,70 @@ using namespace std;
 
 class Graph {
 private:
-    int numVertices;
-    map<char, int> vertexIndex;
-    map<int, char> indexVertex;
+    GraphStore graph;  // Vertex labels plus CSR adjacency over dense indices
     vector<vector<int>> adjMatrix;  // Adjacency matrix for easier clique checking
     set<pair<int, int>> edges;  // Store edges for reference
     
+    string vertexName(uint32_t index) { return graph.vertexName(index); }
+    
+    // Matrix lookup for the example graph; neighbor list search for files
+    // (binary search when the converter stored the lists sorted)
+    bool isAdjacent(uint32_t a, uint32_t b) {
+        if (!graph.isLoaded()) {
+            return adjMatrix[a][b] != 0;
+        }
+        CsrView adj = graph.edges();
+        const uint32_t* first = adj.targets + adj.offsets[a];
+        const uint32_t* last = adj.targets + adj.offsets[a + 1];
+        if (graph.loadedFile().isSorted()) {
+            return binary_search(first, last, b);
+        }
+        return find(first, last, b) != last;
+    }
+    
 public:
     Graph(int n) {
-        numVertices = n;
         adjMatrix.resize(n, vector<int>(n, 0));
     }
     
-    void addVertex(char vertex, int index) {
-        vertexIndex[vertex] = index;
-        indexVertex[index] = vertex;
+    // Replace the example graph with a graph file (see graph_file.h)
+    bool loadFromFile(const string& path) {
+        if (!graph.loadFromFile(path)) return false;
+        adjMatrix.clear();
+        edges.clear();
+        return true;
+    }
+    
+    // Dense index of a vertex label (or number, for unlabeled files), -1 if unknown
+    int64_t findVertex(const string& label) { return graph.findVertex(label); }
+    
+    // The example graph stores every edge both ways; files say so in their header
+    bool isUndirected() { return !graph.isLoaded() || graph.loadedFile().isUndirected(); }
+    
+    // Label of a dense index, for output
+    string vertexLabel(uint32_t index) { return vertexName(index); }
+    
+    void addVertex(const string& vertex) {
+        int index = graph.addVertex(vertex);
+        
+        // Grow the matrix if more vertices are added than announced
+        if (index >= (int)adjMatrix.size()) {
+            for (auto& row : adjMatrix) row.resize(index + 1, 0);
+            adjMatrix.resize(index + 1, vector<int>(index + 1, 0));
+        }
     }
     
-    void addEdge(char from, char to) {
-        int fromIdx = vertexIndex[from];
-        int toIdx = vertexIndex[to];
+    void addEdge(const string& from, const string& to) {
+        addVertex(from);
+        addVertex(to);
+        int fromIdx = (int)findVertex(from);
+        int toIdx = (int)findVertex(to);
         
         // Undirected graph - add edge in both directions
         adjMatrix[fromIdx][toIdx] = 1;
         adjMatrix[toIdx][fromIdx] = 1;
+        graph.addEdge(fromIdx, toIdx, 1);
+        graph.addEdge(toIdx, fromIdx, 1);
         
         // Store edge for display
         if (fromIdx < toIdx) {
@@ -44,7 +88,7 @@ public:
     }
     
     // Function to check if given list of nodes forms a clique
-    bool is_clique(vector<char> list_nodes) {
+    bool is_clique(vector<string> list_nodes) {
         // A clique requires at least 1 node
         if (list_nodes.empty()) {
             return false;
@@ -55,22 +99,35 @@ public:
             return true;
         }
         
+        INSTRUMENT_SCOPE("clique");
+        
         // Check if all nodes exist in the graph
-        for (char node : list_nodes) {
-            if (vertexIndex.find(node) == vertexIndex.end()) {
+        vector<uint32_t> indices;
+        for (const string& node : list_nodes) {
+            int64_t index = findVertex(node);
+            if (index < 0) {
                 cout << "Error: Node '" << node << "' does not exist in graph!" << endl;
                 return false;
             }
+            indices.push_back(index);
+        }
+        
+        return isCliqueByIndex(indices);
+    }
+    
+    // Same check on dense vertex indices. Callers checking many sets open
+    // the "clique" INSTRUMENT_SCOPE once around the loop, not per set.
+    bool isCliqueByIndex(const vector<uint32_t>& nodes) {
+        if (nodes.empty()) {
+            return false;
         }
         
         // Check if every pair of nodes is adjacent
-        for (size_t i = 0; i < list_nodes.size(); i++) {
-            for (size_t j = i + 1; j < list_nodes.size(); j++) {
-                int idx1 = vertexIndex[list_nodes[i]];
-                int idx2 = vertexIndex[list_nodes[j]];
-                
+        for (size_t i = 0; i < nodes.size(); i++) {
+            for (size_t j = i + 1; j < nodes.size(); j++) {
                 // If any pair is not connected, it's not a clique
-                if (adjMatrix[idx1][idx2] == 0) {
+                INSTRUMENT_COUNT(cliquePairChecks, 1);
+                if (!isAdjacent(nodes[i], nodes[j])) {
                     return false;
                 }
             }
@@ -79,8 +136,29 @@ public:
         return true;
     }
     
+    // Number of k-cliques in the whole graph, and per vertex the number
+    // of k-cliques containing it (see clique_counting.h)
+    CliqueCountResult countCliques(const CliqueCountOptions& options) {
+        INSTRUMENT_SCOPE("clique-count");
+        CliqueCounter counter;
+        return counter.run(graph.edges(), options);
+    }
+    
+    void displayCliqueCounts(int k) {
+        CliqueCountOptions options;
+        options.k = k;
+        CliqueCountResult result = countCliques(options);
+        cout << k << "-cliques: " << result.total << endl;
+        cout << "  Per vertex: ";
+        for (size_t v = 0; v < result.perVertex.size(); v++) {
+            cout << vertexName(v) << "=" << result.perVertex[v];
+            if (v < result.perVertex.size() - 1) cout << ", ";
+        }
+        cout << endl;
+    }
+    
     // Helper function to display clique check results
-    void checkAndDisplayClique(vector<char> nodes) {
+    void checkAndDisplayClique(vector<string> nodes) {
         cout << "Checking if {";
         for (size_t i = 0; i < nodes.size(); i++) {
             cout << nodes[i];
@@ -103,25 +181,35 @@ public:
         cout << "\n===============================================" << endl;
         cout << "           CLIQUE DETECTION" << endl;
         cout << "===============================================" << endl;
+        if (graph.isLoaded()) {
+            cout << "\nGraph loaded from file: " << graph.vertexCount() << " vertices, "
+                 << graph.edgeCount() << " edges" << endl;
+            return;
+        }
         cout << "\nGraph from the diagram:" << endl;
+        int numVertices = (int)graph.vertexCount();
         cout << "Vertices: ";
         for (int i = 0; i < numVertices; i++) {
-            cout << indexVertex[i];
+            cout << vertexName(i);
             if (i < numVertices - 1) cout << ", ";
         }
         cout << "\n\nEdges (undirected):" << endl;
         
         for (const auto& edge : edges) {
-            cout << "  " << indexVertex[edge.first] << " -- " 
-                 << indexVertex[edge.second] << endl;
+            cout << "  " << vertexName(edge.first) << " -- " 
+                 << vertexName(edge.second) << endl;
         }
     }
     
     void displayAdjacencyMatrix() {
+        if (graph.isLoaded()) {
+            return;  // No matrix is built for loaded graphs
+        }
+        int numVertices = (int)graph.vertexCount();
         cout << "\nAdjacency Matrix:" << endl;
         cout << "   ";
         for (int i = 0; i < numVertices; i++) {
-            cout << indexVertex[i] << " ";
+            cout << vertexName(i) << " ";
         }
         cout << endl;
         cout << "  ";
@@ -131,7 +219,7 @@ public:
         cout << endl;
         
         for (int i = 0; i < numVertices; i++) {
-            cout << indexVertex[i] << "| ";
+            cout << vertexName(i) << "| ";
             for (int j = 0; j < numVertices; j++) {
                 cout << adjMatrix[i][j] << " ";
             }
@@ -140,31 +228,116 @@ public:
     }
 };
 
-int main() {
+// Counts the k-cliques of a graph file and lists the vertices in most of them:
+// ./question3 --count K graph.dsag [threads]
+int countFileCliques(int argc, char** argv) {
+    if (argc < 4) {
+        cout << "Usage: " << argv[0] << " --count K graph.dsag [threads]" << endl;
+        return 1;
+    }
+    Graph g(0);
+    if (!g.loadFromFile(argv[3])) {
+        return 1;
+    }
+    if (!g.isUndirected()) {
+        cout << "Error: clique counting needs an undirected graph (graph_convert --undirected)" << endl;
+        return 1;
+    }
+    CliqueCountOptions options;
+    options.k = atoi(argv[2]);
+    if (options.k < 1) {
+        cout << "Error: K must be at least 1" << endl;
+        return 1;
+    }
+    if (argc > 4) options.numThreads = max(1, atoi(argv[4]));
+    
+    CliqueCountResult result = g.countCliques(options);
+    cout << options.k << "-cliques: " << result.total << endl;
+    cout << "Degeneracy: " << result.degeneracy << endl;
+    cout << "Time: " << result.seconds << " s (" << options.numThreads << " threads)" << endl;
+    
+    vector<uint32_t> top(result.perVertex.size());
+    for (size_t v = 0; v < top.size(); v++) top[v] = v;
+    size_t shown = min<size_t>(10, top.size());
+    partial_sort(top.begin(), top.begin() + shown, top.end(), [&](uint32_t a, uint32_t b) {
+        return result.perVertex[a] > result.perVertex[b];
+    });
+    cout << "\nVertices in the most " << options.k << "-cliques:" << endl;
+    for (size_t i = 0; i < shown && result.perVertex[top[i]] > 0; i++) {
+        cout << "  " << g.vertexLabel(top[i]) << ": " << result.perVertex[top[i]] << endl;
+    }
+#ifdef DSA_INSTRUMENT
+    instrumentReport(cerr);
+#endif
+    return 0;
+}
+
+// Checks a vertex set from the command line against a graph file:
+// ./question3 graph.dsag v1 v2 v3 ...
+int checkFileClique(int argc, char** argv) {
+    Graph g(0);
+    if (!g.loadFromFile(argv[1])) {
+        return 1;
+    }
+    g.displayGraph();
+    
+    vector<uint32_t> nodes;
+    for (int i = 2; i < argc; i++) {
+        int64_t index = g.findVertex(argv[i]);
+        if (index < 0) {
+            cout << "Error: Node '" << argv[i] << "' does not exist in graph!" << endl;
+            return 1;
+        }
+        nodes.push_back(index);
+    }
+    
+    bool result;
+    {
+        INSTRUMENT_SCOPE("clique");
+        result = g.isCliqueByIndex(nodes);
+    }
+    cout << "\nChecking " << nodes.size() << " vertices: "
+         << (result ? "TRUE ✓" : "FALSE ✗") << endl;
+#ifdef DSA_INSTRUMENT
+    instrumentReport(cerr);
+#endif
+    return 0;
+}
+
+// graph_benchmark.cpp includes this file with DSA_JOURNAL_NO_MAIN defined
+#ifndef DSA_JOURNAL_NO_MAIN
+int main(int argc, char** argv) {
+    if (argc > 1 && string(argv[1]) == "--count") {
+        return countFileCliques(argc, argv);
+    }
+    if (argc > 1) {
+        return checkFileClique(argc, argv);
+    }
+    
     // Create graph based on the diagram (6 vertices: a, b, c, d, e, f)
     Graph g(6);
     
     // Add vertices
-    g.addVertex('a', 0);
-    g.addVertex('b', 1);
-    g.addVertex('c', 2);
-    g.addVertex('d', 3);
-    g.addVertex('e', 4);
-    g.addVertex('f', 5);
+    g.addVertex("a");
+    g.addVertex("b");
+    g.addVertex("c");
+    g.addVertex("d");
+    g.addVertex("e");
+    g.addVertex("f");
     
     // Add edges from the diagram
     // The highlighted clique region shows: a, b, c, d are all connected
-    g.addEdge('a', 'b');
-    g.addEdge('a', 'c');
-    g.addEdge('a', 'd');
-    g.addEdge('b', 'c');
-    g.addEdge('b', 'd');
-    g.addEdge('c', 'd');
+    g.addEdge("a", "b");
+    g.addEdge("a", "c");
+    g.addEdge("a", "d");
+    g.addEdge("b", "c");
+    g.addEdge("b", "d");
+    g.addEdge("c", "d");
     
     // Connections to e and f (outside the clique)
-    g.addEdge('c', 'e');
-    g.addEdge('e', 'f');
-    g.addEdge('d', 'f');
+    g.addEdge("c", "e");
+    g.addEdge("e", "f");
+    g.addEdge("d", "f");
     
     // Display graph information
     g.displayGraph();
@@ -177,28 +350,34 @@ int main() {
     
     // Test 1: The actual clique from the diagram (highlighted region)
     cout << "Test 1: Highlighted clique from diagram" << endl;
-    g.checkAndDisplayClique({'a', 'b', 'c', 'd'});
+    g.checkAndDisplayClique({"a", "b", "c", "d"});
     
     cout << "\nTest 2: Subset of the clique" << endl;
-    g.checkAndDisplayClique({'a', 'b', 'c'});
+    g.checkAndDisplayClique({"a", "b", "c"});
     
     cout << "\nTest 3: Another subset" << endl;
-    g.checkAndDisplayClique({'b', 'd'});
+    g.checkAndDisplayClique({"b", "d"});
     
     cout << "\nTest 4: Not a clique (includes node outside clique)" << endl;
-    g.checkAndDisplayClique({'a', 'b', 'e'});
+    g.checkAndDisplayClique({"a", "b", "e"});
     
     cout << "\nTest 5: Not a clique (e and f are connected but not all pairs)" << endl;
-    g.checkAndDisplayClique({'c', 'e', 'f'});
+    g.checkAndDisplayClique({"c", "e", "f"});
     
     cout << "\nTest 6: Single node (trivially a clique)" << endl;
-    g.checkAndDisplayClique({'a'});
+    g.checkAndDisplayClique({"a"});
     
     cout << "\nTest 7: Two connected nodes" << endl;
-    g.checkAndDisplayClique({'e', 'f'});
+    g.checkAndDisplayClique({"e", "f"});
     
     cout << "\nTest 8: All nodes (not a clique)" << endl;
-    g.checkAndDisplayClique({'a', 'b', 'c', 'd', 'e', 'f'});
+    g.checkAndDisplayClique({"a", "b", "c", "d", "e", "f"});
+    
+    cout << "\n===============================================" << endl;
+    cout << "           CLIQUE COUNTING" << endl;
+    cout << "===============================================\n" << endl;
+    g.displayCliqueCounts(3);
+    g.displayCliqueCounts(4);
     
     cout << "\n===============================================" << endl;
     cout << "\nDefinition:" << endl;
@@ -211,3 +390,4 @@ int main() {
     
     return 0;
 }
+#endif
@@ -1,10 +1,26 @@
 #include <iostream>
 #include <vector>
 #include <queue>
-#include <map>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <iomanip>
+#include <sstream>
 #include <set>
 #include <climits>
 #include <algorithm>
+#include <string>
+#include <cstdlib>
+#include "graph_store.h"
+#include "hamiltonian_search.h"
+#include "result_sink.h"
+#include "batched_dijkstra.h"
+#include "adaptive_graph.h"
+#include "compressed_adjacency.h"
+#include "lazy_traversal.h"
+#include "betweenness.h"
+#include "graph_instrumentation.h"
 using namespace std;
 
 // ===============================================
@@ -14,7 +30,22 @@ using namespace std;
 class PrimeGraph {
 private:
     int N;
-    vector<vector<int>> adjList;
+    bool compressedStorage;      // keep the lists in `compressed` instead of `graph`
+    GraphStore graph;            // Adjacency lists built by buildGraph(), vertices are numbers
+    CompressedGraph compressed;  // Same lists delta-encoded (compressed_adjacency.h)
+    
+    CsrView edges() { return graph.edges(); }
+    
+    // Calls f with the adjacency actually held, so the methods below are
+    // written once for both storages
+    template <class F>
+    void withAdjacency(F f) {
+        if (compressedStorage) {
+            f(compressed);
+        } else {
+            f(SparseGraph::borrow(edges(), true));
+        }
+    }
     
     // Function to check if a number is prime
     bool isPrime(int num) {
@@ -29,27 +60,80 @@ private:
     }
     
 public:
-    PrimeGraph(int n) : N(n) {
-        adjList.resize(N + 1);  // Index 0 unused, vertices are 1 to N
+    PrimeGraph(int n, bool compressedLists = false) : N(n), compressedStorage(compressedLists) {
         buildGraph();
     }
     
     void buildGraph() {
-        // For each pair of vertices (i, j), add edge if i + j is prime
+        if (compressedStorage) {
+            buildCompressed();
+            return;
+        }
+        graph.reserveVertices(N + 1);  // Index 0 unused, vertices are 1 to N
+        
+        // Sums range over 3..2N, so each one is tested for primality once
+        vector<bool> primeSum(2 * N + 1);
+        for (int s = 3; s <= 2 * N; s++) primeSum[s] = isPrime(s);
+        
+        // For each pair of vertices i < j, add edge if i + j is prime.
+        // Each pair is visited once and stored from both ends. The CSR build
+        // keeps arcs of a vertex in the order they were added, so row i gets
+        // its k < i neighbours (added on earlier rows) and then j > i: sorted.
         for (int i = 1; i <= N; i++) {
             for (int j = i + 1; j <= N; j++) {
-                if (isPrime(i + j)) {
-                    // Undirected graph - add edge in both directions
-                    adjList[i].push_back(j);
-                    adjList[j].push_back(i);
+                if (primeSum[i + j]) {
+                    graph.addEdge(i, j, 1);
+                    graph.addEdge(j, i, 1);
                 }
             }
         }
-        
-        // Sort adjacency lists for consistent output
-        for (int i = 1; i <= N; i++) {
-            sort(adjList[i].begin(), adjList[i].end());
+    }
+    
+    // Compressed lists are encoded row by row without building the CSR
+    // arrays first. The neighbours of i are p - i for the primes p in
+    // [i + 1, i + N] other than 2i, so each row comes out sorted from one walk over a
+    // prime table.
+    void buildCompressed() {
+        vector<uint32_t> primes;
+        for (int s = 2; s <= 2 * N; s++) {
+            if (isPrime(s)) primes.push_back(s);
         }
+        compressed = CompressedGraph::fromRows(N + 1, [&](uint64_t i, vector<uint32_t>& row) {
+            if (i == 0) return;  // Index 0 unused
+            for (auto p = lower_bound(primes.begin(), primes.end(), (uint32_t)i + 1);
+                 p != primes.end() && *p <= i + N; ++p) {
+                if (*p != 2 * i) row.push_back(*p - (uint32_t)i);
+            }
+        });
+    }
+    
+    // Use a prime graph saved with saveToFile() instead of rebuilding it
+    bool loadFromFile(const string& path) {
+        if (compressedStorage) {
+            GraphFile file;
+            if (!file.open(path)) return false;
+            compressed = CompressedGraph::fromCsr(file.view());
+            N = (int)compressed.numVertices() - 1;
+            return true;
+        }
+        if (!graph.loadFromFile(path)) return false;
+        N = (int)graph.vertexCount() - 1;
+        return true;
+    }
+    
+    bool saveToFile(const string& path) {
+        vector<uint64_t> offsets;
+        vector<uint32_t> targets;
+        CsrView adj = compressedStorage ? compressed.decompress(offsets, targets) : edges();
+        adj.weights = nullptr;  // Prime graph edges are unweighted
+        return writeGraphFile(path, adj, GRAPH_FILE_UNDIRECTED | GRAPH_FILE_SORTED);
+    }
+    
+    // Bytes taken by the adjacency lists in the storage in use
+    uint64_t adjacencyBytes() {
+        if (compressedStorage) return compressed.bytes();
+        CsrView adj = edges();
+        return CompressedGraph::csrBytes(adj.numVertices, adj.numEdges);
     }
     
     void displayGraph() {
@@ -62,59 +146,166 @@ public:
         cout << "Adjacency List Representation:" << endl;
         cout << "-------------------------------" << endl;
         
-        for (int i = 1; i <= N; i++) {
-            cout << "(" << (char)('a' + i - 1) << ") " << i;
-            if (!adjList[i].empty()) {
-                cout << ", ";
-                for (size_t j = 0; j < adjList[i].size(); j++) {
-                    cout << adjList[i][j];
-                    if (j < adjList[i].size() - 1) cout << ",";
-                }
+        withAdjacency([&](const auto& adj) {
+            for (int i = 1; i <= N; i++) {
+                cout << "(" << (char)('a' + i - 1) << ") " << i;
+                const char* separator = ", ";
+                adj.forEachNeighbor(i, [&](uint32_t neighbor, int) {
+                    cout << separator << neighbor;
+                    separator = ",";
+                });
+                cout << endl;
             }
-            cout << endl;
-        }
+        });
         
         cout << "\nEdge Explanation:" << endl;
-        for (int i = 1; i <= N; i++) {
-            for (int neighbor : adjList[i]) {
-                if (i < neighbor) {  // Print each edge only once
-                    cout << "  " << i << " -- " << neighbor 
-                         << " (sum = " << (i + neighbor) << ", prime)" << endl;
-                }
+        TextFormat format;
+        format.edgePrefix = "  ";
+        format.edgeSeparator = " -- ";
+        format.valuePrefix = " (sum = ";
+        format.valueSuffix = ", prime)";
+        TextSink out(stdout, nullptr, format);
+        emitEdges(out);
+    }
+    
+    // Every edge once (smaller vertex first) with its prime sum as the value
+    void emitEdges(ResultSink& out) {
+        withAdjacency([&](const auto& adj) {
+            for (int i = 1; i <= N; i++) {
+                adj.forEachNeighbor(i, [&](uint32_t neighbor, int) {
+                    if ((uint32_t)i < neighbor) {  // Print each edge only once
+                        out.edge(i, neighbor, i + neighbor);
+                    }
+                });
             }
-        }
+        });
+    }
+    
+    // BFS order from `start`, sent to `out` as vertices are dequeued
+    void bfs(int start, ResultSink& out) {
+        INSTRUMENT_SCOPE("prime-bfs");
+        withAdjacency([&](const auto& adj) {
+            vector<bool> visited(N + 1, false);
+            vector<int> q;  // Queue as a plain array: each vertex enters once
+            size_t head = 0;
+            FrontierCounter frontier;  // level sizes, only with DSA_INSTRUMENT
+            
+            out.beginList("BFS Order");
+            q.push_back(start);
+            visited[start] = true;
+            
+            while (head < q.size()) {
+                frontier.next(head, q.size());
+                int current = q[head++];
+                out.listVertex(current);
+                INSTRUMENT_COUNT(verticesVisited, 1);
+                INSTRUMENT_COUNT(edgesScanned, adj.degree(current));
+                
+                adj.forEachNeighbor(current, [&](uint32_t neighbor, int) {
+                    if (!visited[neighbor]) {
+                        visited[neighbor] = true;
+                        q.push_back(neighbor);
+                    }
+                });
+            }
+            frontier.finish(q.size());
+            out.endList();
+        });
     }
     
     void traverseGraph() {
         cout << "\n\nGraph Traversal (BFS from vertex 1):" << endl;
         cout << "------------------------------------" << endl;
         
-        vector<bool> visited(N + 1, false);
-        queue<int> q;
-        vector<int> traversalOrder;
+        TextSink out(stdout);
+        bfs(1, out);
+    }
+    
+    // Lazy BFS over either storage (lazy_traversal.h): f(step) for each
+    // vertex reached, with depth and parent, until f returns false
+    template <class F>
+    void bfsSteps(int start, TraversalLimits limits, F f) {
+        withAdjacency([&](const auto& adj) {
+            LazyBFS<decltype(adj)> bfs(adj, start, limits);
+            for (const TraversalStep& step : bfs) {
+                if (!f(step)) break;
+            }
+        });
+    }
+    
+    // BFS from vertex 1 that stops at `target` or below `maxDepth`
+    void traverseUntil(int target, uint32_t maxDepth) {
+        cout << "\n\nBFS from vertex 1 until " << target << " (depth limit " << maxDepth << "):" << endl;
+        cout << "------------------------------------" << endl;
         
-        q.push(1);
-        visited[1] = true;
+        TraversalLimits limits;
+        limits.maxDepth = maxDepth;
+        bool found = false;
+        bfsSteps(1, limits, [&](const TraversalStep& step) {
+            cout << step.vertex << " (depth " << step.depth;
+            if (step.parent >= 0) cout << ", from " << step.parent;
+            cout << ")" << endl;
+            found = step.vertex == (uint32_t)target;
+            return !found;
+        });
+        if (!found) cout << target << " not reached" << endl;
+    }
+    
+    // Prime ring problem: arrange 1..N in a circle (or a line, for a path)
+    // so that every two neighbours sum to a prime. That is a Hamiltonian
+    // cycle (path) in this graph; see hamiltonian_search.h.
+    HamiltonianResult findPrimeRings(const HamiltonianOptions& options) {
+        INSTRUMENT_SCOPE("prime-ring");
+        if (N > 64) {
+            cout << "Error: prime ring search supports N up to 64" << endl;
+            return HamiltonianResult();
+        }
         
-        while (!q.empty()) {
-            int current = q.front();
-            q.pop();
-            traversalOrder.push_back(current);
-            
-            for (int neighbor : adjList[current]) {
-                if (!visited[neighbor]) {
-                    visited[neighbor] = true;
-                    q.push(neighbor);
-                }
+        // Bit i - 1 of a mask stands for vertex i
+        vector<uint64_t> masks(N, 0);
+        withAdjacency([&](const auto& adj) {
+            for (int i = 1; i <= N; i++) {
+                adj.forEachNeighbor(i, [&](uint32_t neighbor, int) {
+                    masks[i - 1] |= 1ULL << (neighbor - 1);
+                });
             }
+        });
+        
+        HamiltonianSearch search(masks);
+        HamiltonianResult result = search.run(options);
+        for (int& v : result.firstSolution) v += 1;
+        return result;
+    }
+    
+    void displayPrimeRings(const HamiltonianOptions& options) {
+        const char* shape = options.cycle ? "ring" : "line";
+        cout << "\n\nPrime " << shape << " search (N = " << N << "):" << endl;
+        cout << "------------------------------------" << endl;
+        
+        HamiltonianResult result = findPrimeRings(options);
+        if (result.rejectedByParity) {
+            cout << "No prime " << shape << " exists: odd and even numbers must alternate," << endl;
+            cout << "so their counts have to " << (options.cycle ? "match" : "differ by at most one") << endl;
+            return;
         }
         
-        cout << "BFS Order: ";
-        for (size_t i = 0; i < traversalOrder.size(); i++) {
-            cout << traversalOrder[i];
-            if (i < traversalOrder.size() - 1) cout << " -> ";
+        if (options.stopAtFirst) {
+            cout << (result.solutions ? "Found a prime " : "No prime ") << shape << endl;
+        } else {
+            cout << "Prime " << shape << "s" << (options.cycle ? " starting at 1" : "")
+                 << ": " << result.solutions << endl;
         }
-        cout << endl;
+        if (!result.firstSolution.empty()) {
+            cout << "Example: ";
+            for (size_t i = 0; i < result.firstSolution.size(); i++) {
+                cout << result.firstSolution[i];
+                if (i < result.firstSolution.size() - 1) cout << " - ";
+            }
+            cout << endl;
+        }
+        cout << "Search nodes: " << result.nodes << " in " << result.seconds << " s ("
+             << (uint64_t)result.nodesPerSecond() << " nodes/s, "
+             << options.numThreads << " threads)" << endl;
     }
 };
 
@@ -122,78 +313,167 @@ public:
 // TASK 2: Dijkstra's Shortest Path Algorithm
 // ===============================================
 
+// Keeps the final distance (LLONG_MAX if unreachable) and parent of
+// every vertex from settled records
+class DistanceRecorder : public ResultSink {
+public:
+    vector<long long> dist;
+    vector<int> parent;
+    
+    DistanceRecorder(int numVertices) : dist(numVertices, LLONG_MAX), parent(numVertices, -1) {}
+    
+    void settled(uint32_t v, int64_t d, int64_t p) override {
+        dist[v] = d;
+        parent[v] = (int)p;
+    }
+};
+
+// Prints the step log of the example run and keeps the final distances
+// and parents for the path table
+class DijkstraStepPrinter : public DistanceRecorder {
+private:
+    function<string(uint32_t)> name;
+    int step = 1;
+    
+public:
+    DijkstraStepPrinter(int numVertices, function<string(uint32_t)> names)
+        : DistanceRecorder(numVertices), name(names) {}
+    
+    void settled(uint32_t v, int64_t d, int64_t p) override {
+        DistanceRecorder::settled(v, d, p);
+        cout << "Step " << step++ << ": Visit vertex " << name(v) 
+             << " (distance: " << d << ")\n";
+    }
+    
+    void relaxed(uint32_t v, int64_t d, uint32_t) override {
+        cout << "  → Update " << name(v) << ": distance = " << d << "\n";
+    }
+};
+
 class DijkstraGraph {
 private:
-    int numVertices;
-    map<int, char> indexToVertex;
-    map<char, int> vertexToIndex;
-    vector<vector<pair<int, int>>> adjList;  // pair<destination, weight>
+    GraphStore graph;  // Vertex labels plus weighted CSR adjacency (destination, weight)
+    
+    string vertexName(uint32_t index) { return graph.vertexName(index); }
+    CsrView edges() { return graph.edges(); }
+    
+    // One thread's batches at a time go to `out`, whole batches at once
+    template <int K>
+    void runBatches(const vector<uint32_t>& sources, ResultSink& out, unsigned numThreads) {
+        CsrView adj = edges();
+        mutex outLock;
+        batchedDijkstra<K>(adj, sources, numThreads, [&](uint64_t first, int count, const BatchedDijkstra<K>& search) {
+            lock_guard<mutex> guard(outLock);
+            for (int lane = 0; lane < count; lane++) {
+                for (uint64_t v = 0; v < adj.numVertices; v++) {
+                    out.distance(sources[first + lane], v, search.distance(v, lane));
+                }
+            }
+        });
+    }
     
 public:
-    DijkstraGraph(int n) : numVertices(n) {
-        adjList.resize(n);
+    DijkstraGraph(int n) {
+        graph.reserveVertices(n);
+    }
+    
+    // Replace the graph with a graph file (see graph_file.h).
+    // Unweighted files are treated as having weight 1 on every edge.
+    bool loadFromFile(const string& path) {
+        return graph.loadFromFile(path);
+    }
+    
+    // Dense index of a vertex label (or number, for unlabeled files), -1 if unknown
+    int64_t findVertex(const string& label) { return graph.findVertex(label); }
+    
+    // Dense index of the input's first vertex, wherever reorder() moved it
+    int64_t firstVertex() { return graph.currentIndex(0); }
+    uint64_t vertexCount() { return graph.vertexCount(); }
+    bool hasNegativeWeights() { return edges().minWeight() < 0; }
+    
+    // Relabel the vertices for cache locality before running anything
+    // (see vertex_ordering.h); openOutput() sinks undo it on output
+    void reorder(VertexOrder order, unsigned numThreads = defaultThreadCount()) {
+        graph.reorder(order, numThreads);
     }
     
-    void addVertex(char vertex, int index) {
-        vertexToIndex[vertex] = index;
-        indexToVertex[index] = vertex;
+    // Sink for results from a command line spec, in the input's numbering
+    unique_ptr<ResultSink> openOutput(const string& spec) { return graph.openOutput(spec); }
+    
+    void addVertex(const string& vertex) {
+        graph.addVertex(vertex);
     }
     
-    void addEdge(char from, char to, int weight) {
-        int fromIdx = vertexToIndex[from];
-        int toIdx = vertexToIndex[to];
-        adjList[fromIdx].push_back({toIdx, weight});
+    void addEdge(const string& from, const string& to, int weight) {
+        graph.addEdge(from, to, weight);
     }
     
-    void dijkstra(char source) {
-        int srcIdx = vertexToIndex[source];
+    void dijkstra(const string& source) { dijkstra((int)findVertex(source)); }
+    
+    // Settled vertices and every distance improvement go to `out`
+    void dijkstra(int srcIdx, ResultSink& out) {
+        INSTRUMENT_SCOPE("dijkstra");
+        CsrView adj = edges();
+        int numVertices = (int)graph.vertexCount();
         
-        // Distance array initialized to infinity
-        vector<int> dist(numVertices, INT_MAX);
+        // Distance array initialized to infinity (64-bit so long paths
+        // in large loaded graphs cannot overflow)
+        vector<long long> dist(numVertices, LLONG_MAX);
         vector<int> parent(numVertices, -1);
         vector<bool> visited(numVertices, false);
         
         // Priority queue: pair<distance, vertex>
-        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+        priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> pq;
         
         dist[srcIdx] = 0;
         pq.push({0, srcIdx});
-        
-        cout << "\n===============================================" << endl;
-        cout << "   TASK 2: DIJKSTRA'S SHORTEST PATH" << endl;
-        cout << "===============================================" << endl;
-        cout << "\nSource vertex: " << source << "\n" << endl;
-        
-        cout << "Algorithm Steps:" << endl;
-        cout << "----------------" << endl;
-        int step = 1;
+        INSTRUMENT_COUNT(heapPushes, 1);
         
         while (!pq.empty()) {
             int u = pq.top().second;
-            int currentDist = pq.top().first;
             pq.pop();
             
-            if (visited[u]) continue;
+            if (visited[u]) {
+                INSTRUMENT_COUNT(stalePops, 1);
+                continue;
+            }
             visited[u] = true;
-            
-            cout << "Step " << step++ << ": Visit vertex " << indexToVertex[u] 
-                 << " (distance: " << currentDist << ")" << endl;
+            out.settled(u, dist[u], parent[u]);
+            INSTRUMENT_COUNT(verticesVisited, 1);
+            INSTRUMENT_COUNT(edgesScanned, adj.degree(u));
             
             // Update distances to neighbors
-            for (auto& edge : adjList[u]) {
-                int v = edge.first;
-                int weight = edge.second;
+            for (uint64_t e = adj.offsets[u]; e < adj.offsets[u + 1]; e++) {
+                int v = adj.targets[e];
+                int weight = adj.weight(e);
                 
-                if (!visited[v] && dist[u] != INT_MAX && dist[u] + weight < dist[v]) {
+                if (!visited[v] && dist[u] + weight < dist[v]) {
                     dist[v] = dist[u] + weight;
                     parent[v] = u;
                     pq.push({dist[v], v});
-                    
-                    cout << "  → Update " << indexToVertex[v] 
-                         << ": distance = " << dist[v] << endl;
+                    out.relaxed(v, dist[v], u);
+                    INSTRUMENT_COUNT(relaxations, 1);
+                    INSTRUMENT_COUNT(heapPushes, 1);
                 }
             }
         }
+    }
+    
+    void dijkstra(int srcIdx) {
+        string source = vertexName(srcIdx);
+        int numVertices = (int)graph.vertexCount();
+        
+        cout << "\n===============================================" << endl;
+        cout << "   TASK 2: DIJKSTRA'S SHORTEST PATH" << endl;
+        cout << "===============================================" << endl;
+        cout << "\nSource vertex: " << source << "\n" << endl;
+        
+        cout << "Algorithm Steps:" << endl;
+        cout << "----------------" << endl;
+        DijkstraStepPrinter steps(numVertices, [this](uint32_t v) { return vertexName(v); });
+        dijkstra(srcIdx, steps);
+        vector<long long>& dist = steps.dist;
+        vector<int>& parent = steps.parent;
         
         // Display results
         cout << "\n\nShortest Path Results:" << endl;
@@ -201,9 +481,9 @@ public:
         cout << "From vertex " << source << " to all other vertices:\n" << endl;
         
         for (int i = 0; i < numVertices; i++) {
-            cout << source << " → " << indexToVertex[i] << ": ";
+            cout << source << " → " << vertexName(i) << ": ";
             
-            if (dist[i] == INT_MAX) {
+            if (dist[i] == LLONG_MAX) {
                 cout << "No path exists" << endl;
             } else {
                 cout << "Distance = " << dist[i];
@@ -219,7 +499,7 @@ public:
                 
                 cout << ", Path: ";
                 for (size_t j = 0; j < path.size(); j++) {
-                    cout << indexToVertex[path[j]];
+                    cout << vertexName(path[j]);
                     if (j < path.size() - 1) cout << " → ";
                 }
                 cout << endl;
@@ -227,19 +507,117 @@ public:
         }
     }
     
+    // Labels for output, e.g. to build a sink with openResultSink()
+    function<string(uint32_t)> names() {
+        return [this](uint32_t v) { return vertexName(v); };
+    }
+    
+    // Distances from many sources, computed 8 or 16 at a time in SIMD
+    // lanes (batched_dijkstra.h), sent to `out` as distance records.
+    // Falls back to one dijkstra() per source if 32-bit lanes could overflow.
+    // False, with nothing computed, if the graph has negative weights.
+    bool dijkstraMany(const vector<uint32_t>& sources, ResultSink& out, unsigned numThreads = 1) {
+        INSTRUMENT_SCOPE("dijkstra-batch");
+        int numVertices = (int)graph.vertexCount();
+        if (edges().minWeight() < 0) {
+            return false;
+        }
+        if (!BatchedDijkstra<8>::fitsLanes(edges())) {
+            for (uint32_t source : sources) {
+                DistanceRecorder recorder(numVertices);
+                dijkstra(source, recorder);
+                for (int v = 0; v < numVertices; v++) {
+                    out.distance(source, v, recorder.dist[v] == LLONG_MAX ? -1 : recorder.dist[v]);
+                }
+            }
+            return true;
+        }
+        
+        // 16 lanes only pay off when every thread gets full batches
+        if (sources.size() >= 16 * (size_t)numThreads) runBatches<16>(sources, out, numThreads);
+        else runBatches<8>(sources, out, numThreads);
+        return true;
+    }
+    
+    // Betweenness centrality of every vertex by Brandes' algorithm on
+    // Dijkstra (betweenness.h): the share of weighted shortest paths
+    // between other vertices that pass through it. Sources run in
+    // parallel, or a sample of them when options.epsilon is set.
+    // False, with nothing computed, unless every weight is positive.
+    bool betweenness(BetweennessResult& result, BetweennessOptions options = BetweennessOptions()) {
+        INSTRUMENT_SCOPE("betweenness");
+        if (edges().minWeight() <= 0) {
+            return false;
+        }
+        options.weighted = true;
+        options.undirected = graph.isLoaded() && graph.loadedFile().isUndirected();
+        result = betweennessCentrality(edges(), options);
+        return true;
+    }
+    
+    void displayBetweenness() {
+        cout << "\n\nBetweenness Centrality (Brandes on Dijkstra):" << endl;
+        cout << "=============================================" << endl;
+        BetweennessResult result;
+        betweenness(result);
+        for (uint32_t v = 0; v < result.centrality.size(); v++) {
+            cout << vertexName(v) << ": " << fixed << setprecision(3) << result.centrality[v] << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        cout << "(C reaches E by three paths of length 10: C→E, C→D→E and C→B→D→E)" << endl;
+    }
+    
+    // Shortest distance between every pair of vertices, all sources in
+    // one batched run
+    void displayAllPairs() {
+        int numVertices = (int)graph.vertexCount();
+        vector<uint32_t> sources(numVertices);
+        for (int i = 0; i < numVertices; i++) sources[i] = i;
+        
+        // Collects the distance records into a matrix
+        struct MatrixSink : public ResultSink {
+            vector<vector<long long>> table;
+            void distance(uint32_t source, uint32_t v, int64_t d) override { table[source][v] = d; }
+        } matrix;
+        matrix.table.assign(numVertices, vector<long long>(numVertices, -1));
+        dijkstraMany(sources, matrix);
+        
+        cout << "\n\nAll-Pairs Shortest Distances (batched Dijkstra):" << endl;
+        cout << "=================================================" << endl;
+        cout << "From\\To";
+        for (int j = 0; j < numVertices; j++) cout << setw(5) << vertexName(j);
+        cout << endl;
+        for (int i = 0; i < numVertices; i++) {
+            cout << setw(7) << vertexName(i);
+            for (int j = 0; j < numVertices; j++) {
+                if (matrix.table[i][j] < 0) cout << setw(5) << "-";
+                else cout << setw(5) << matrix.table[i][j];
+            }
+            cout << endl;
+        }
+    }
+    
     void displayGraph() {
         cout << "\nDirected Weighted Graph:" << endl;
         cout << "------------------------" << endl;
+        if (graph.isLoaded()) {
+            cout << "Loaded from file: " << graph.vertexCount() << " vertices, "
+                 << graph.edgeCount() << " edges" << endl;
+            return;
+        }
         
+        CsrView adj = edges();
+        int numVertices = (int)adj.numVertices;
         for (int i = 0; i < numVertices; i++) {
-            cout << indexToVertex[i] << " → ";
-            if (adjList[i].empty()) {
+            cout << vertexName(i) << " → ";
+            if (adj.degree(i) == 0) {
                 cout << "NULL";
             } else {
-                for (size_t j = 0; j < adjList[i].size(); j++) {
-                    cout << indexToVertex[adjList[i][j].first] 
-                         << "(" << adjList[i][j].second << ")";
-                    if (j < adjList[i].size() - 1) cout << ", ";
+                for (uint64_t e = adj.offsets[i]; e < adj.offsets[i + 1]; e++) {
+                    cout << vertexName(adj.targets[e]) 
+                         << "(" << adj.weight(e) << ")";
+                    if (e < adj.offsets[i + 1] - 1) cout << ", ";
                 }
             }
             cout << endl;
@@ -247,7 +625,220 @@ public:
     }
 };
 
-int main() {
+// Command line modes working on graph files (see graph_file.h):
+//   ./question4 graph.dsag [source] [output]
+//                                           Dijkstra on a loaded graph; output is
+//                                           -, text:PATH, binary:PATH or null
+//   ./question4 --batch graph.dsag SOURCES [threads] [output]
+//                                           distances from many sources at once;
+//                                           SOURCES is "all" or names like A,B,C
+//   ./question4 --betweenness graph.dsag [threads] [EPSILON]
+//                                           the 10 most central vertices by
+//                                           weighted shortest paths; EPSILON > 0
+//                                           samples sources (see betweenness.h)
+//   ./question4 --prime N out.dsag          save the prime sum graph for N
+//   ./question4 --prime-bfs N [--compressed] [output]
+//                                           BFS from 1 in the prime sum graph for N,
+//                                           with compressed adjacency lists if asked
+//   ./question4 --ring N [threads] [--first] [--path]
+//                                           prime ring search for N
+//   --order NAME (anywhere) relabels a loaded graph for locality first,
+//   NAME being degree, bfs, rcm or gorder; results keep the file's numbering.
+//   The prime graph modes build their graph in code and refuse it.
+int runFileMode(int argc, char** argv) {
+    VertexOrder order;
+    if (!takeOrderOption(argc, argv, order)) {
+        return 1;
+    }
+    if (argc < 2) {
+        cout << "Error: --order needs a graph file" << endl;
+        return 1;
+    }
+    auto applyOrder = [order](DijkstraGraph& dg) {
+        if (order == ORDER_ORIGINAL) return;
+        auto begin = chrono::steady_clock::now();
+        dg.reorder(order);
+        cerr << "Reorder (" << vertexOrderName(order) << "): "
+             << chrono::duration<double>(chrono::steady_clock::now() - begin).count() << " s" << endl;
+    };
+    string mode = argv[1];
+    if (order != ORDER_ORIGINAL && (mode == "--ring" || mode == "--prime" || mode == "--prime-bfs")) {
+        cout << "Error: --order only applies to graph files, not " << mode << endl;
+        return 1;
+    }
+    if (mode == "--ring") {
+        if (argc < 3) {
+            cout << "Usage: " << argv[0] << " --ring N [threads] [--first] [--path]" << endl;
+            return 1;
+        }
+        HamiltonianOptions options;
+        for (int i = 3; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--first") options.stopAtFirst = true;
+            else if (arg == "--path") options.cycle = false;
+            else options.numThreads = max(1, atoi(argv[i]));
+        }
+        PrimeGraph pg(atoi(argv[2]));
+        pg.displayPrimeRings(options);
+        return 0;
+    }
+    if (mode == "--prime") {
+        if (argc < 4) {
+            cout << "Usage: " << argv[0] << " --prime N out.dsag" << endl;
+            return 1;
+        }
+        PrimeGraph pg(atoi(argv[2]));
+        return pg.saveToFile(argv[3]) ? 0 : 1;
+    }
+    if (mode == "--prime-bfs") {
+        if (argc < 3) {
+            cout << "Usage: " << argv[0] << " --prime-bfs N [--compressed] [output]" << endl;
+            return 1;
+        }
+        if (atoi(argv[2]) < 2) {
+            cout << "Error: N must be at least 2" << endl;
+            return 1;
+        }
+        bool compressedLists = argc > 3 && string(argv[3]) == "--compressed";
+        auto begin = chrono::steady_clock::now();
+        PrimeGraph pg(atoi(argv[2]), compressedLists);
+        uint64_t bytes = pg.adjacencyBytes();  // also packs the CSR arrays, outside the BFS timing
+        double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        int outputArg = compressedLists ? 4 : 3;
+        unique_ptr<ResultSink> out = openResultSink(argc > outputArg ? argv[outputArg] : "null", nullptr);
+        if (!out) {
+            return 1;
+        }
+        
+        begin = chrono::steady_clock::now();
+        pg.bfs(1, *out);
+        out->flush();
+        cerr << "Adjacency: " << bytes << " bytes ("
+             << (compressedLists ? "compressed" : "CSR") << "), built in " << buildSeconds << " s" << endl;
+        cerr << "BFS: " << chrono::duration<double>(chrono::steady_clock::now() - begin).count()
+             << " s" << endl;
+#ifdef DSA_INSTRUMENT
+        instrumentReport(cerr);
+#endif
+        return 0;
+    }
+    if (mode == "--batch") {
+        if (argc < 4) {
+            cout << "Usage: " << argv[0] << " --batch graph.dsag SOURCES [threads] [output]" << endl;
+            return 1;
+        }
+        DijkstraGraph dg(0);
+        if (!dg.loadFromFile(argv[2])) {
+            return 1;
+        }
+        applyOrder(dg);
+        vector<uint32_t> sources;
+        string list = argv[3];
+        if (list == "all") {
+            for (uint64_t v = 0; v < dg.vertexCount(); v++) sources.push_back((uint32_t)v);
+        } else {
+            stringstream names(list);
+            string name;
+            while (getline(names, name, ',')) {
+                int64_t source = dg.findVertex(name);
+                if (source < 0) {
+                    cout << "Error: Node '" << name << "' does not exist in graph!" << endl;
+                    return 1;
+                }
+                sources.push_back((uint32_t)source);
+            }
+        }
+        unsigned numThreads = argc > 4 ? (unsigned)max(1, atoi(argv[4])) : 1;
+        unique_ptr<ResultSink> out = dg.openOutput(argc > 5 ? argv[5] : "-");
+        if (!out) {
+            return 1;
+        }
+        
+        // Results are "source vertex distance" records; time goes to stderr
+        auto begin = chrono::steady_clock::now();
+        if (!dg.dijkstraMany(sources, *out, numThreads)) {
+            cout << "Error: Dijkstra needs non-negative edge weights" << endl;
+            return 1;
+        }
+        out->flush();
+        cerr << "Batched Dijkstra: " << sources.size() << " sources in "
+             << chrono::duration<double>(chrono::steady_clock::now() - begin).count() << " s" << endl;
+#ifdef DSA_INSTRUMENT
+        instrumentReport(cerr);
+#endif
+        return 0;
+    }
+    
+    if (mode == "--betweenness") {
+        if (argc < 3) {
+            cout << "Usage: " << argv[0] << " --betweenness graph.dsag [threads] [EPSILON]" << endl;
+            return 1;
+        }
+        DijkstraGraph dg(0);
+        if (!dg.loadFromFile(argv[2])) {
+            return 1;
+        }
+        applyOrder(dg);
+        BetweennessOptions options;
+        if (argc > 3) options.numThreads = (unsigned)max(1, atoi(argv[3]));
+        if (argc > 4) options.epsilon = atof(argv[4]);
+        
+        auto begin = chrono::steady_clock::now();
+        BetweennessResult result;
+        if (!dg.betweenness(result, options)) {
+            cout << "Error: betweenness needs positive edge weights" << endl;
+            return 1;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        for (uint32_t v : mostCentral(result.centrality, 10)) {
+            cout << dg.names()(v) << " " << result.centrality[v] << endl;
+        }
+        cerr << "Betweenness: " << result.sources << (result.sampled ? " sampled" : "") << " sources in "
+             << seconds << " s" << endl;
+#ifdef DSA_INSTRUMENT
+        instrumentReport(cerr);
+#endif
+        return 0;
+    }
+    
+    DijkstraGraph dg(0);
+    if (!dg.loadFromFile(mode)) {
+        return 1;
+    }
+    if (dg.hasNegativeWeights()) {
+        cout << "Error: Dijkstra needs non-negative edge weights" << endl;
+        return 1;
+    }
+    applyOrder(dg);
+    int64_t source = argc > 2 ? dg.findVertex(argv[2]) : dg.firstVertex();
+    if (source < 0) {
+        cout << "Error: Node '" << argv[2] << "' does not exist in graph!" << endl;
+        return 1;
+    }
+    unique_ptr<ResultSink> out = dg.openOutput(argc > 3 ? argv[3] : "-");
+    if (!out) {
+        return 1;
+    }
+    
+    // Results are "vertex distance parent" records; time goes to stderr
+    auto begin = chrono::steady_clock::now();
+    dg.dijkstra((int)source, *out);
+    out->flush();
+    cerr << "Dijkstra: " << chrono::duration<double>(chrono::steady_clock::now() - begin).count()
+         << " s" << endl;
+#ifdef DSA_INSTRUMENT
+    instrumentReport(cerr);
+#endif
+    return 0;
+}
+
+// graph_benchmark.cpp includes this file with DSA_JOURNAL_NO_MAIN defined
+#ifndef DSA_JOURNAL_NO_MAIN
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return runFileMode(argc, argv);
+    }
+    
     // ==================== TASK 1 ====================
     cout << "\n\n";
     cout << "###############################################" << endl;
@@ -258,6 +849,14 @@ int main() {
     PrimeGraph pg(7);
     pg.displayGraph();
     pg.traverseGraph();
+    pg.traverseUntil(5, 2);
+    
+    // Prime ring: N = 7 is odd, so only a line can exist
+    HamiltonianOptions ringOptions;
+    ringOptions.numThreads = 1;
+    pg.displayPrimeRings(ringOptions);
+    ringOptions.cycle = false;
+    pg.displayPrimeRings(ringOptions);
     
     // ==================== TASK 2 ====================
     cout << "\n\n";
@@ -266,26 +865,32 @@ int main() {
     // Using a typical example graph
     DijkstraGraph dg(5);
     
-    dg.addVertex('A', 0);
-    dg.addVertex('B', 1);
-    dg.addVertex('C', 2);
-    dg.addVertex('D', 3);
-    dg.addVertex('E', 4);
+    dg.addVertex("A");
+    dg.addVertex("B");
+    dg.addVertex("C");
+    dg.addVertex("D");
+    dg.addVertex("E");
     
     // Add weighted directed edges
-    dg.addEdge('A', 'B', 4);
-    dg.addEdge('A', 'C', 2);
-    dg.addEdge('B', 'C', 1);
-    dg.addEdge('B', 'D', 5);
-    dg.addEdge('C', 'B', 3);
-    dg.addEdge('C', 'D', 8);
-    dg.addEdge('C', 'E', 10);
-    dg.addEdge('D', 'E', 2);
+    dg.addEdge("A", "B", 4);
+    dg.addEdge("A", "C", 2);
+    dg.addEdge("B", "C", 1);
+    dg.addEdge("B", "D", 5);
+    dg.addEdge("C", "B", 3);
+    dg.addEdge("C", "D", 8);
+    dg.addEdge("C", "E", 10);
+    dg.addEdge("D", "E", 2);
     
     dg.displayGraph();
     
     // Run Dijkstra's algorithm from vertex A
-    dg.dijkstra('A');
+    dg.dijkstra("A");
+    
+    // Distances from every vertex at once
+    dg.displayAllPairs();
+    
+    // How many shortest paths run through each vertex
+    dg.displayBetweenness();
     
     cout << "\n\n";
     cout << "===============================================" << endl;
@@ -299,7 +904,12 @@ int main() {
     cout << "  Time Complexity: O((V + E) log V) with priority queue" << endl;
     cout << "  Space Complexity: O(V)" << endl;
     cout << "  Note: Works only for graphs with non-negative weights" << endl;
+    
+    cout << "\nBetweenness Centrality (Brandes):" << endl;
+    cout << "  Time Complexity: O(V × (V + E) log V), sources split over the threads" << endl;
+    cout << "  Space Complexity: O(V) per thread" << endl;
     cout << "===============================================\n" << endl;
     
     return 0;
 }
+#endif
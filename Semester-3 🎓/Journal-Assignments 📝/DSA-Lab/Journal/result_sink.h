@@ -0,0 +1,282 @@
+#ifndef DSA_RESULT_SINK_H
+#define DSA_RESULT_SINK_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+// Where graph algorithms send their results. An algorithm emits each
+// record as soon as it is known instead of printing, so the same code can
+// write readable text, a compact binary stream, or nothing at all (to time
+// the algorithm alone). Every record is optional for a sink to handle.
+// Tentative distances (relaxed) can outnumber the results many times
+// over, so TextSink and BinarySink only write them when asked to.
+class ResultSink {
+public:
+    virtual ~ResultSink() {}
+
+    // An ordered list of vertices, e.g. a traversal order
+    virtual void beginList(const string& /* title */) {}
+    virtual void listVertex(uint32_t /* v */) {}
+    virtual void endList() {}
+
+    // An edge with a value attached (weight, vertex sum, ...)
+    virtual void edge(uint32_t /* from */, uint32_t /* to */, int64_t /* value */) {}
+
+    // Shortest paths: v got its final distance; parent is -1 for the source
+    virtual void settled(uint32_t /* v */, int64_t /* dist */, int64_t /* parent */) {}
+    // A tentative distance improved during the search
+    virtual void relaxed(uint32_t /* v */, int64_t /* dist */, uint32_t /* parent */) {}
+    // Final distance from one of several sources (-1 if unreachable)
+    virtual void distance(uint32_t /* source */, uint32_t /* v */, int64_t /* dist */) {}
+
+    virtual void flush() {}
+};
+
+// Discards everything; counts records so benchmarks can check the work
+// was really done.
+class NullSink : public ResultSink {
+public:
+    uint64_t records = 0;
+
+    void listVertex(uint32_t) override { records++; }
+    void edge(uint32_t, uint32_t, int64_t) override { records++; }
+    void settled(uint32_t, int64_t, int64_t) override { records++; }
+    void relaxed(uint32_t, int64_t, uint32_t) override { records++; }
+    void distance(uint32_t, uint32_t, int64_t) override { records++; }
+};
+
+// Collects output bytes in a large buffer and hands them to a FILE* in
+// big writes. Writes go through the FILE* (not the raw descriptor) so
+// text sent to stdout stays in order with cout output around it.
+class BufferedWriter {
+private:
+    FILE* out;
+    bool ownsFile;
+    vector<char> buffer;
+    size_t used = 0;
+
+public:
+    BufferedWriter(FILE* file, bool owns, size_t bufferSize)
+        : out(file), ownsFile(owns), buffer(bufferSize) {}
+
+    ~BufferedWriter() {
+        flush();
+        if (ownsFile) fclose(out);
+    }
+
+    void write(const char* data, size_t length) {
+        if (used + length > buffer.size()) {
+            flush();
+            if (length > buffer.size()) {
+                fwrite(data, 1, length, out);
+                return;
+            }
+        }
+        memcpy(buffer.data() + used, data, length);
+        used += length;
+    }
+
+    void write(const string& text) { write(text.data(), text.size()); }
+
+    void writeNumber(int64_t value) {
+        char digits[24];
+        int length = snprintf(digits, sizeof(digits), "%lld", (long long)value);
+        write(digits, length);
+    }
+
+    template <class T>
+    void writeRaw(const T& value) { write((const char*)&value, sizeof(T)); }
+
+    void flush() {
+        if (used > 0) fwrite(buffer.data(), 1, used, out);
+        used = 0;
+        fflush(out);
+    }
+};
+
+// Separators used by TextSink. The defaults give one record per line in
+// the same "from to value" form graph_convert reads.
+struct TextFormat {
+    string listSeparator = " -> ";
+    string edgePrefix = "";
+    string edgeSeparator = " ";
+    string valuePrefix = " ";
+    string valueSuffix = "";
+    bool relaxations = false;  // also write tentative distances as "~ v dist parent"
+};
+
+// Human-readable text, vertices printed through `name` (dense index when
+// no name function is given).
+class TextSink : public ResultSink {
+private:
+    BufferedWriter writer;
+    function<string(uint32_t)> name;
+    TextFormat format;
+    bool firstInList = true;
+
+    void writeVertex(uint32_t v) {
+        if (name) writer.write(name(v));
+        else writer.writeNumber(v);
+    }
+
+public:
+    TextSink(FILE* out, function<string(uint32_t)> names = nullptr, TextFormat fmt = TextFormat(),
+             size_t bufferSize = 1 << 20, bool ownsFile = false)
+        : writer(out, ownsFile, bufferSize), name(names), format(fmt) {}
+
+    void beginList(const string& title) override {
+        writer.write(title);
+        writer.write(": ", 2);
+        firstInList = true;
+    }
+
+    void listVertex(uint32_t v) override {
+        if (!firstInList) writer.write(format.listSeparator);
+        firstInList = false;
+        writeVertex(v);
+    }
+
+    void endList() override {
+        writer.write("\n", 1);
+        writer.flush();  // lists are usually followed by cout output
+    }
+
+    void edge(uint32_t from, uint32_t to, int64_t value) override {
+        writer.write(format.edgePrefix);
+        writeVertex(from);
+        writer.write(format.edgeSeparator);
+        writeVertex(to);
+        writer.write(format.valuePrefix);
+        writer.writeNumber(value);
+        writer.write(format.valueSuffix);
+        writer.write("\n", 1);
+    }
+
+    void settled(uint32_t v, int64_t dist, int64_t parent) override {
+        writeVertex(v);
+        writer.write(" ", 1);
+        writer.writeNumber(dist);
+        writer.write(" ", 1);
+        if (parent < 0) writer.write("-", 1);
+        else writeVertex((uint32_t)parent);
+        writer.write("\n", 1);
+    }
+
+    void relaxed(uint32_t v, int64_t dist, uint32_t parent) override {
+        if (!format.relaxations) return;
+        writer.write("~ ", 2);
+        writeVertex(v);
+        writer.write(" ", 1);
+        writer.writeNumber(dist);
+        writer.write(" ", 1);
+        writeVertex(parent);
+        writer.write("\n", 1);
+    }
+
+    void distance(uint32_t source, uint32_t v, int64_t dist) override {
+        writeVertex(source);
+        writer.write(" ", 1);
+        writeVertex(v);
+        writer.write(" ", 1);
+        if (dist < 0) writer.write("-", 1);
+        else writer.writeNumber(dist);
+        writer.write("\n", 1);
+    }
+
+    void flush() override { writer.flush(); }
+};
+
+// Compact binary stream: every record is a one-byte type followed by
+// fixed-size little-endian fields.
+//   'L' u32 titleLength, title bytes   begin list
+//   'v' u32 vertex                     list vertex
+//   'l'                                end list
+//   'e' u32 from, u32 to, i64 value    edge
+//   's' u32 v, i64 dist, i64 parent    settled
+//   'r' u32 v, i64 dist, u32 parent    relaxed, only if `relaxations` is set
+//   'd' u32 source, u32 v, i64 dist    distance from one of several sources
+class BinarySink : public ResultSink {
+private:
+    BufferedWriter writer;
+    bool relaxations;
+
+public:
+    BinarySink(FILE* out, size_t bufferSize = 1 << 20, bool ownsFile = false, bool withRelaxations = false)
+        : writer(out, ownsFile, bufferSize), relaxations(withRelaxations) {}
+
+    void beginList(const string& title) override {
+        writer.writeRaw('L');
+        writer.writeRaw((uint32_t)title.size());
+        writer.write(title);
+    }
+
+    void listVertex(uint32_t v) override {
+        writer.writeRaw('v');
+        writer.writeRaw(v);
+    }
+
+    void endList() override { writer.writeRaw('l'); }
+
+    void edge(uint32_t from, uint32_t to, int64_t value) override {
+        writer.writeRaw('e');
+        writer.writeRaw(from);
+        writer.writeRaw(to);
+        writer.writeRaw(value);
+    }
+
+    void settled(uint32_t v, int64_t dist, int64_t parent) override {
+        writer.writeRaw('s');
+        writer.writeRaw(v);
+        writer.writeRaw(dist);
+        writer.writeRaw(parent);
+    }
+
+    void relaxed(uint32_t v, int64_t dist, uint32_t parent) override {
+        if (!relaxations) return;
+        writer.writeRaw('r');
+        writer.writeRaw(v);
+        writer.writeRaw(dist);
+        writer.writeRaw(parent);
+    }
+
+    void distance(uint32_t source, uint32_t v, int64_t dist) override {
+        writer.writeRaw('d');
+        writer.writeRaw(source);
+        writer.writeRaw(v);
+        writer.writeRaw(dist);
+    }
+
+    void flush() override { writer.flush(); }
+};
+
+// Sink from a command line spec: "-" or "text" (stdout), "text:PATH",
+// "binary:PATH" or "null". Returns nullptr and prints an error if the
+// spec is bad or the file cannot be created.
+inline unique_ptr<ResultSink> openResultSink(const string& spec, function<string(uint32_t)> names) {
+    if (spec == "null") return unique_ptr<ResultSink>(new NullSink());
+    if (spec == "-" || spec == "text") return unique_ptr<ResultSink>(new TextSink(stdout, names));
+
+    size_t colon = spec.find(':');
+    string kind = spec.substr(0, colon);
+    if (colon == string::npos || (kind != "text" && kind != "binary")) {
+        cerr << "Error: output must be -, text:PATH, binary:PATH or null" << endl;
+        return nullptr;
+    }
+    string path = spec.substr(colon + 1);
+    FILE* file = fopen(path.c_str(), kind == "binary" ? "wb" : "w");
+    if (!file) {
+        cerr << "Error: cannot create " << path << endl;
+        return nullptr;
+    }
+    if (kind == "binary") return unique_ptr<ResultSink>(new BinarySink(file, 1 << 20, true));
+    return unique_ptr<ResultSink>(new TextSink(file, names, TextFormat(), 1 << 20, true));
+}
+
+#endif
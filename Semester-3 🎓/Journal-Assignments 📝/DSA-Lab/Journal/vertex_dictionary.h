@@ -0,0 +1,245 @@
+#ifndef DSA_VERTEX_DICTIONARY_H
+#define DSA_VERTEX_DICTIONARY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "parallel.h"
+using namespace std;
+
+// Maps external vertex IDs (names or 64-bit numbers) to dense indices
+// 0..size()-1 and back. Algorithms only ever see the dense indices; the
+// external ID is looked up again when results are printed.
+//
+// The table is split into 64 shards by the top hash bits, each an
+// open-addressing table with linear probing. Sharding is what lets
+// buildBulk() fill the table from many threads without locks.
+
+inline uint64_t mixHash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t vertexKeyHash(uint64_t key) {
+    return mixHash(key + 0x9e3779b97f4a7c15ULL);
+}
+
+inline uint64_t vertexKeyHash(string_view key) {
+    uint64_t h = key.size() * 0x9e3779b97f4a7c15ULL;
+    size_t i = 0;
+    for (; i + 8 <= key.size(); i += 8) {
+        uint64_t word;
+        memcpy(&word, key.data() + i, 8);
+        h = mixHash(h ^ word);
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, key.data() + i, key.size() - i);
+    return mixHash(h ^ tail);
+}
+
+template <class Key>
+class VertexDictionary {
+private:
+    static const int SHARD_BITS = 6;
+    static const int NUM_SHARDS = 1 << SHARD_BITS;
+    static const uint32_t EMPTY = UINT32_MAX;
+
+    struct Slot {
+        uint32_t tag;  // low hash bits, filters most mismatches without touching keys
+        uint32_t id;   // dense index, EMPTY for a free slot
+    };
+
+    struct Shard {
+        vector<Slot> slots;
+        uint64_t count = 0;
+
+        // Returns the id stored for the key, or EMPTY (with `pos` at the
+        // free slot where it belongs). keyOf(id) gives the key of an id.
+        template <class KeyOf>
+        uint32_t probe(uint64_t hash, const Key& key, KeyOf keyOf, uint64_t& pos) const {
+            uint64_t mask = slots.size() - 1;
+            uint32_t tag = (uint32_t)hash;
+            for (pos = (hash >> 8) & mask;; pos = (pos + 1) & mask) {
+                const Slot& slot = slots[pos];
+                if (slot.id == EMPTY) return EMPTY;
+                if (slot.tag == tag && keyOf(slot.id) == key) return slot.id;
+            }
+        }
+
+        // Keep the load factor at or below 1/2
+        template <class KeyOf>
+        void reserveFor(uint64_t entries, KeyOf keyOf) {
+            if (entries * 2 <= slots.size()) return;
+            uint64_t capacity = 16;
+            while (capacity < entries * 2) capacity *= 2;
+            vector<Slot> old;
+            old.swap(slots);
+            slots.assign(capacity, Slot{0, EMPTY});
+            for (const Slot& slot : old) {
+                if (slot.id == EMPTY) continue;
+                uint64_t hash = vertexKeyHash(keyOf(slot.id));
+                uint64_t pos;
+                probe(hash, keyOf(slot.id), keyOf, pos);
+                slots[pos] = slot;
+            }
+        }
+    };
+
+    vector<Key> keys;  // dense index -> external ID
+    vector<Shard> shards;
+
+    static int shardOf(uint64_t hash) { return (int)(hash >> (64 - SHARD_BITS)); }
+
+public:
+    VertexDictionary() : shards(NUM_SHARDS) {}
+
+    size_t size() const { return keys.size(); }
+    const Key& key(uint32_t index) const { return keys[index]; }
+
+    void clear() {
+        keys.clear();
+        for (Shard& shard : shards) {
+            shard.slots.clear();
+            shard.count = 0;
+        }
+    }
+
+    // Dense index of `key`, or -1 if it was never added
+    int64_t find(const Key& key) const {
+        uint64_t hash = vertexKeyHash(key);
+        const Shard& shard = shards[shardOf(hash)];
+        if (shard.slots.empty()) return -1;
+        uint64_t pos;
+        uint32_t id = shard.probe(hash, key, [&](uint32_t i) -> const Key& { return keys[i]; }, pos);
+        return id == EMPTY ? -1 : (int64_t)id;
+    }
+
+    // Dense index of `key`, adding it with the next free index if new
+    uint32_t add(const Key& key) {
+        auto keyOf = [&](uint32_t i) -> const Key& { return keys[i]; };
+        uint64_t hash = vertexKeyHash(key);
+        Shard& shard = shards[shardOf(hash)];
+        shard.reserveFor(shard.count + 1, keyOf);
+        uint64_t pos;
+        uint32_t id = shard.probe(hash, key, keyOf, pos);
+        if (id != EMPTY) return id;
+
+        id = (uint32_t)keys.size();
+        keys.push_back(key);
+        shard.slots[pos] = Slot{(uint32_t)hash, id};
+        shard.count++;
+        return id;
+    }
+
+    // Adds many keys at once (duplicates allowed) from `numThreads` threads.
+    // New keys get indices in order of first appearance, exactly as calling
+    // add() on each key in turn would. If `indexOf` is given it receives the
+    // dense index of every input key, e.g. both endpoints of every edge.
+    void buildBulk(const vector<Key>& input, vector<uint32_t>* indexOf,
+                   unsigned numThreads = defaultThreadCount()) {
+        uint64_t n = input.size();
+        vector<uint64_t> hashes(n);
+        parallelForChunks(n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) hashes[i] = vertexKeyHash(input[i]);
+        });
+
+        // Partition input positions by shard, keeping input order inside
+        // each shard (per-thread counts, then a prefix sum over them)
+        unsigned chunks = (unsigned)max<uint64_t>(1, min<uint64_t>(numThreads, n));
+        vector<vector<uint64_t>> chunkCounts(chunks, vector<uint64_t>(NUM_SHARDS, 0));
+        parallelForChunks(n, chunks, [&](unsigned t, uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) chunkCounts[t][shardOf(hashes[i])]++;
+        });
+        vector<uint64_t> shardStart(NUM_SHARDS + 1, 0);
+        vector<vector<uint64_t>> chunkNext(chunks, vector<uint64_t>(NUM_SHARDS));
+        uint64_t running = 0;
+        for (int s = 0; s < NUM_SHARDS; s++) {
+            shardStart[s] = running;
+            for (unsigned t = 0; t < chunks; t++) {
+                chunkNext[t][s] = running;
+                running += chunkCounts[t][s];
+            }
+        }
+        shardStart[NUM_SHARDS] = running;
+        vector<uint64_t> byShard(n);
+        parallelForChunks(n, chunks, [&](unsigned t, uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) byShard[chunkNext[t][shardOf(hashes[i])]++] = i;
+        });
+
+        // Each shard is filled by one thread. While building, a slot holds
+        // a shard-local entry number; firstPos maps it to the input position
+        // where that key first appeared.
+        uint32_t oldSize = (uint32_t)keys.size();
+        vector<vector<uint64_t>> firstPos(NUM_SHARDS);
+        vector<uint32_t> entryOf(n);
+        parallelForDynamic(NUM_SHARDS, numThreads, [&](unsigned, uint64_t s) {
+            Shard& shard = shards[s];
+            vector<uint64_t>& first = firstPos[s];
+            auto keyOf = [&](uint32_t id) -> const Key& {
+                return id < oldSize ? keys[id] : input[first[id - oldSize]];
+            };
+            for (uint64_t k = shardStart[s]; k < shardStart[s + 1]; k++) {
+                uint64_t i = byShard[k];
+                shard.reserveFor(shard.count + 1, keyOf);
+                uint64_t pos;
+                uint32_t id = shard.probe(hashes[i], input[i], keyOf, pos);
+                if (id == EMPTY) {
+                    id = oldSize + (uint32_t)first.size();  // temporary shard-local id
+                    first.push_back(i);
+                    shard.slots[pos] = Slot{(uint32_t)hashes[i], id};
+                    shard.count++;
+                }
+                entryOf[i] = id;
+            }
+        });
+        vector<uint64_t>().swap(byShard);
+
+        // Final index of a new key = number of new keys first seen before it
+        vector<vector<uint32_t>> finalId(NUM_SHARDS);
+        for (int s = 0; s < NUM_SHARDS; s++) finalId[s].resize(firstPos[s].size());
+        vector<uint64_t> chunkNew(chunks + 1, 0);
+        auto isFirst = [&](uint64_t i, int s) {
+            uint32_t id = entryOf[i];
+            return id >= oldSize && firstPos[s][id - oldSize] == i;
+        };
+        parallelForChunks(n, chunks, [&](unsigned t, uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) chunkNew[t + 1] += isFirst(i, shardOf(hashes[i]));
+        });
+        for (unsigned t = 0; t < chunks; t++) chunkNew[t + 1] += chunkNew[t];
+        keys.resize(oldSize + chunkNew[chunks]);
+        parallelForChunks(n, chunks, [&](unsigned t, uint64_t begin, uint64_t end) {
+            uint32_t next = oldSize + (uint32_t)chunkNew[t];
+            for (uint64_t i = begin; i < end; i++) {
+                int s = shardOf(hashes[i]);
+                if (isFirst(i, s)) {
+                    finalId[s][entryOf[i] - oldSize] = next;
+                    keys[next++] = input[i];
+                }
+            }
+        });
+
+        // Swap temporary ids for final ones, in the table and in indexOf
+        parallelForDynamic(NUM_SHARDS, numThreads, [&](unsigned, uint64_t s) {
+            for (Slot& slot : shards[s].slots) {
+                if (slot.id != EMPTY && slot.id >= oldSize) slot.id = finalId[s][slot.id - oldSize];
+            }
+        });
+        if (indexOf) {
+            indexOf->resize(n);
+            parallelForChunks(n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+                for (uint64_t i = begin; i < end; i++) {
+                    uint32_t id = entryOf[i];
+                    (*indexOf)[i] = id < oldSize ? id : finalId[shardOf(hashes[i])][id - oldSize];
+                }
+            });
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,404 @@
+#ifndef DSA_VERTEX_ORDERING_H
+#define DSA_VERTEX_ORDERING_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "graph_file.h"
+#include "parallel.h"
+#include "result_sink.h"
+using namespace std;
+
+// Relabels the vertices of a graph so that vertices used together get
+// nearby indices. BFS and Dijkstra then touch the CSR rows and their own
+// per-vertex arrays (visited, dist, ...) in fewer cache lines than with
+// indices in file order, which on large graphs is close to random.
+//
+// Orderings (new index -> old index):
+//  - ORDER_DEGREE: highest degree first; the hubs, which most edges
+//    point at, share a few cache lines
+//  - ORDER_BFS:    BFS visiting order, one component after another
+//  - ORDER_RCM:    reverse Cuthill-McKee, BFS from a pseudo-peripheral
+//                  vertex taking neighbours by ascending degree, then
+//                  reversed; keeps every edge close to the diagonal
+//  - ORDER_GORDER: greedy Gorder (Wei et al.): next is the vertex with the
+//                  most edges and common neighbours to the last
+//                  GORDER_WINDOW placed ones (following out-edges, so
+//                  best on undirected graphs)
+//
+// Degrees, the relabelled CSR arrays and the mapping are built in
+// parallel. BFS, RCM and Gorder orders are one sequential walk each,
+// linear in the edges (Gorder: in the edges times the window).
+//
+// Algorithms run on ReorderedGraph::view() report new indices;
+// RelabelSink turns them back into original ones on output.
+
+enum VertexOrder { ORDER_ORIGINAL, ORDER_DEGREE, ORDER_BFS, ORDER_RCM, ORDER_GORDER };
+
+inline const char* vertexOrderName(VertexOrder order) {
+    switch (order) {
+        case ORDER_DEGREE: return "degree";
+        case ORDER_BFS: return "bfs";
+        case ORDER_RCM: return "rcm";
+        case ORDER_GORDER: return "gorder";
+        default: return "original";
+    }
+}
+
+inline bool parseVertexOrder(const string& name, VertexOrder& order) {
+    for (VertexOrder o : {ORDER_ORIGINAL, ORDER_DEGREE, ORDER_BFS, ORDER_RCM, ORDER_GORDER}) {
+        if (name == vertexOrderName(o)) {
+            order = o;
+            return true;
+        }
+    }
+    cerr << "Error: order must be original, degree, bfs, rcm or gorder" << endl;
+    return false;
+}
+
+// Removes "--order NAME" from the command line, wherever it is, so the
+// remaining arguments keep their positions. False on a bad name.
+inline bool takeOrderOption(int& argc, char** argv, VertexOrder& order) {
+    order = ORDER_ORIGINAL;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) != "--order") continue;
+        if (i + 1 >= argc) {
+            cerr << "Error: --order needs a name" << endl;
+            return false;
+        }
+        if (!parseVertexOrder(argv[i + 1], order)) return false;
+        for (int j = i; j + 2 < argc; j++) argv[j] = argv[j + 2];
+        argc -= 2;
+        break;
+    }
+    return true;
+}
+
+class VertexOrdering {
+public:
+    static const int GORDER_WINDOW = 5;
+
+private:
+    const CsrView& g;
+    unsigned numThreads;
+    vector<uint32_t> degrees;
+
+    // All vertices by descending degree, ties by index (counting sort)
+    vector<uint32_t> byDegree() const {
+        uint64_t n = g.numVertices;
+        uint32_t maxDegree = 0;
+        for (uint32_t d : degrees) maxDegree = max(maxDegree, d);
+        vector<uint64_t> start(maxDegree + 2, 0);
+        for (uint32_t d : degrees) start[maxDegree - d + 1]++;
+        for (uint32_t d = 0; d <= maxDegree; d++) start[d + 1] += start[d];
+        vector<uint32_t> order(n);
+        for (uint64_t v = 0; v < n; v++) order[start[maxDegree - degrees[v]]++] = (uint32_t)v;
+        return order;
+    }
+
+    vector<uint32_t> bfsOrder() const {
+        vector<uint32_t> order;
+        order.reserve(g.numVertices);
+        vector<bool> placed(g.numVertices, false);
+        for (uint32_t root : byDegree()) {
+            if (placed[root]) continue;
+            placed[root] = true;
+            order.push_back(root);
+            for (size_t head = order.size() - 1; head < order.size(); head++) {
+                uint32_t u = order[head];
+                for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                    uint32_t v = g.targets[e];
+                    if (!placed[v]) {
+                        placed[v] = true;
+                        order.push_back(v);
+                    }
+                }
+            }
+        }
+        return order;
+    }
+
+    // Last BFS level from `root` among unplaced vertices; `seen` holds the
+    // sweep number that last reached each vertex
+    int lastLevel(uint32_t root, const vector<bool>& placed, vector<uint32_t>& seen, uint32_t sweep,
+                  vector<uint32_t>& level) const {
+        vector<uint32_t> next;
+        level.assign(1, root);
+        seen[root] = sweep;
+        int depth = 0;
+        while (true) {
+            next.clear();
+            for (uint32_t u : level) {
+                for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                    uint32_t v = g.targets[e];
+                    if (!placed[v] && seen[v] != sweep) {
+                        seen[v] = sweep;
+                        next.push_back(v);
+                    }
+                }
+            }
+            if (next.empty()) return depth;
+            level.swap(next);
+            depth++;
+        }
+    }
+
+    vector<uint32_t> rcmOrder() const {
+        uint64_t n = g.numVertices;
+        vector<uint32_t> order;
+        order.reserve(n);
+        vector<bool> placed(n, false);
+        vector<uint32_t> seen(n, 0), level, children;
+        uint32_t sweep = 0;
+
+        vector<uint32_t> roots = byDegree();
+        reverse(roots.begin(), roots.end());  // lowest degree first
+        for (uint32_t root : roots) {
+            if (placed[root]) continue;
+
+            // Pseudo-peripheral start (George and Liu): move to a lowest
+            // degree vertex of the last level while the depth grows
+            int depth = lastLevel(root, placed, seen, ++sweep, level);
+            for (int tries = 0; tries < 4; tries++) {
+                uint32_t candidate = *min_element(level.begin(), level.end(), [&](uint32_t a, uint32_t b) {
+                    return degrees[a] < degrees[b];
+                });
+                vector<uint32_t> candidateLevel;
+                int candidateDepth = lastLevel(candidate, placed, seen, ++sweep, candidateLevel);
+                if (candidateDepth <= depth) break;
+                root = candidate;
+                depth = candidateDepth;
+                level.swap(candidateLevel);
+            }
+
+            // Cuthill-McKee: BFS taking new neighbours by ascending degree
+            placed[root] = true;
+            order.push_back(root);
+            for (size_t head = order.size() - 1; head < order.size(); head++) {
+                uint32_t u = order[head];
+                children.clear();
+                for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                    uint32_t v = g.targets[e];
+                    if (!placed[v]) {
+                        placed[v] = true;
+                        children.push_back(v);
+                    }
+                }
+                stable_sort(children.begin(), children.end(), [&](uint32_t a, uint32_t b) {
+                    return degrees[a] < degrees[b];
+                });
+                order.insert(order.end(), children.begin(), children.end());
+            }
+        }
+        reverse(order.begin(), order.end());
+        return order;
+    }
+
+    // Gorder's unit heap: unplaced vertices in one linked list per score,
+    // so a +1 or -1 change and taking a top vertex are O(1) amortised
+    class UnitHeap {
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+        vector<uint32_t> prev, next, head;  // head[score]: first vertex with that score
+        vector<uint32_t> key;
+        uint32_t top = 0;
+
+        void unlink(uint32_t v) {
+            if (prev[v] != NONE) next[prev[v]] = next[v];
+            else head[key[v]] = next[v];
+            if (next[v] != NONE) prev[next[v]] = prev[v];
+        }
+
+        void link(uint32_t v) {
+            if (key[v] >= head.size()) head.resize(key[v] + 1, NONE);
+            prev[v] = NONE;
+            next[v] = head[key[v]];
+            if (next[v] != NONE) prev[next[v]] = v;
+            head[key[v]] = v;
+            top = max(top, key[v]);
+        }
+
+    public:
+        // All vertices at score 0; among equal scores `initial` order wins
+        UnitHeap(const vector<uint32_t>& initial)
+            : prev(initial.size(), NONE), next(initial.size(), NONE), head(1, NONE), key(initial.size(), 0) {
+            for (size_t i = initial.size(); i-- > 0;) link(initial[i]);
+        }
+
+        void change(uint32_t v, int delta) {
+            unlink(v);
+            key[v] += delta;
+            link(v);
+        }
+
+        // Removes and returns a vertex of the highest score
+        uint32_t pop() {
+            while (head[top] == NONE) top--;
+            uint32_t v = head[top];
+            unlink(v);
+            return v;
+        }
+    };
+
+    // A vertex's score is its links to the window: +1 for each window
+    // vertex it is a neighbour of, +1 for each neighbour it shares with
+    // one (a sibling). Siblings are only counted through neighbours of
+    // degree up to `hub`, as in the paper, so hubs do not cost deg^2.
+    // Vertices linked to nothing come in degree order.
+    vector<uint32_t> gorderOrder() const {
+        uint64_t n = g.numVertices;
+        uint32_t hub = (uint32_t)max(64.0, sqrt((double)n));
+        vector<bool> placed(n, false);
+        UnitHeap heap(byDegree());
+
+        auto update = [&](uint32_t u, int delta) {
+            for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+                uint32_t v = g.targets[e];
+                if (!placed[v]) heap.change(v, delta);
+                if (degrees[v] > hub) continue;
+                for (uint64_t f = g.offsets[v]; f < g.offsets[v + 1]; f++) {
+                    uint32_t sibling = g.targets[f];
+                    if (sibling != u && !placed[sibling]) heap.change(sibling, delta);
+                }
+            }
+        };
+
+        vector<uint32_t> order;
+        order.reserve(n);
+        while (order.size() < n) {
+            uint32_t next = heap.pop();
+            placed[next] = true;
+            order.push_back(next);
+            update(next, 1);
+            if (order.size() > GORDER_WINDOW) update(order[order.size() - 1 - GORDER_WINDOW], -1);
+        }
+        return order;
+    }
+
+public:
+    VertexOrdering(const CsrView& graph, unsigned threads = defaultThreadCount())
+        : g(graph), numThreads(max(1u, threads)), degrees(graph.numVertices) {
+        parallelForChunks(g.numVertices, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+            for (uint64_t v = begin; v < end; v++) degrees[v] = (uint32_t)g.degree(v);
+        });
+    }
+
+    // Old index of every new index
+    vector<uint32_t> compute(VertexOrder order) const {
+        switch (order) {
+            case ORDER_DEGREE: return byDegree();
+            case ORDER_BFS: return bfsOrder();
+            case ORDER_RCM: return rcmOrder();
+            case ORDER_GORDER: return gorderOrder();
+            default: {
+                vector<uint32_t> identity(g.numVertices);
+                for (uint64_t v = 0; v < g.numVertices; v++) identity[v] = (uint32_t)v;
+                return identity;
+            }
+        }
+    }
+};
+
+// Mean |u - v| over all arcs u -> v: how far apart, in index order, the
+// two ends of an edge are. Smaller means better locality.
+inline double meanEdgeSpan(const CsrView& g) {
+    double total = 0;
+    for (uint64_t u = 0; u < g.numVertices; u++) {
+        for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            total += fabs((double)g.targets[e] - (double)u);
+        }
+    }
+    return g.numEdges ? total / g.numEdges : 0;
+}
+
+// A graph relabelled by a vertex order: its own CSR arrays over the new
+// indices, plus the mapping both ways. Each row keeps the order of the
+// input's row, so traversals visit neighbours in the same order as without
+// the relabelling and give the same results once mapped back.
+class ReorderedGraph {
+private:
+    vector<uint64_t> offsets;
+    vector<uint32_t> targets;
+    vector<int32_t> weights;
+    vector<uint32_t> oldIndex;  // new -> old
+    vector<uint32_t> newIndex;  // old -> new
+    CsrView csr;
+
+public:
+    ReorderedGraph(const CsrView& g, VertexOrder order, unsigned numThreads = defaultThreadCount()) {
+        numThreads = max(1u, numThreads);
+        uint64_t n = g.numVertices;
+        oldIndex = VertexOrdering(g, numThreads).compute(order);
+        newIndex.resize(n);
+        parallelForChunks(n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+            for (uint64_t v = begin; v < end; v++) newIndex[oldIndex[v]] = (uint32_t)v;
+        });
+
+        offsets.assign(n + 1, 0);
+        for (uint64_t v = 0; v < n; v++) offsets[v + 1] = offsets[v] + g.degree(oldIndex[v]);
+        targets.resize(g.numEdges);
+        if (g.weights) weights.resize(g.numEdges);
+        parallelForChunks(n, numThreads, [&](unsigned, uint64_t begin, uint64_t end) {
+            for (uint64_t v = begin; v < end; v++) {
+                uint32_t old = oldIndex[v];
+                uint64_t to = offsets[v];
+                for (uint64_t e = g.offsets[old]; e < g.offsets[old + 1]; e++, to++) {
+                    targets[to] = newIndex[g.targets[e]];
+                    if (g.weights) weights[to] = g.weights[e];
+                }
+            }
+        });
+
+        csr.numVertices = n;
+        csr.numEdges = g.numEdges;
+        csr.offsets = offsets.data();
+        csr.targets = targets.data();
+        csr.weights = g.weights ? weights.data() : nullptr;
+    }
+
+    // The arrays are owned and csr points into them
+    ReorderedGraph(const ReorderedGraph&) = delete;
+    ReorderedGraph& operator=(const ReorderedGraph&) = delete;
+
+    const CsrView& view() const { return csr; }
+    uint32_t originalIndex(uint32_t v) const { return oldIndex[v]; }
+    uint32_t currentIndex(uint32_t original) const { return newIndex[original]; }
+    const vector<uint32_t>& originalIndices() const { return oldIndex; }
+};
+
+// Passes records on with every vertex index mapped through `original`
+// (new index -> old index), so results computed on a ReorderedGraph come
+// out in the numbering of the input
+class RelabelSink : public ResultSink {
+private:
+    unique_ptr<ResultSink> out;
+    const vector<uint32_t>& original;
+
+public:
+    RelabelSink(unique_ptr<ResultSink> sink, const vector<uint32_t>& originalIndex)
+        : out(move(sink)), original(originalIndex) {}
+
+    void beginList(const string& title) override { out->beginList(title); }
+    void listVertex(uint32_t v) override { out->listVertex(original[v]); }
+    void endList() override { out->endList(); }
+
+    void edge(uint32_t from, uint32_t to, int64_t value) override {
+        out->edge(original[from], original[to], value);
+    }
+    void settled(uint32_t v, int64_t dist, int64_t parent) override {
+        out->settled(original[v], dist, parent < 0 ? parent : (int64_t)original[parent]);
+    }
+    void relaxed(uint32_t v, int64_t dist, uint32_t parent) override {
+        out->relaxed(original[v], dist, original[parent]);
+    }
+    void distance(uint32_t source, uint32_t v, int64_t dist) override {
+        out->distance(original[source], original[v], dist);
+    }
+
+    void flush() override { out->flush(); }
+};
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+#include <climits>
+#include "library_stats.h"
+using namespace std;
+
+/* ================= BOOK STRUCT ================= */
+struct Book {
+    int id;
+    string title;
+    string author;
+    int year;
+};
+
+/* ================= YEAR INDEX ================= */
+// Books ordered by year (then ID), kept next to BookArray so sorted
+// listings and year ranges never touch or reorder the array itself.
+//
+// Most books sit in one sorted run. New books go into a small sorted
+// buffer and deleted ones are marked in a sorted list of removals; when
+// the two together pass about sqrt(n) entries they are merged into a new
+// run in one linear pass (the merge step of merge sort). A query binary
+// searches the run and the buffer and walks them side by side, so it
+// costs O(log n + k + pending changes) for k results.
+class YearIndex {
+private:
+    vector<Book> run;      // sorted
+    vector<Book> added;    // sorted, not in run yet
+    vector<Book> removed;  // sorted, still in run but deleted
+
+    // Full order so that two entries compare equal only if they are
+    // identical, which makes removing one copy of a duplicate safe
+    static bool before(const Book& a, const Book& b) {
+        return tie(a.year, a.id, a.title, a.author) < tie(b.year, b.id, b.title, b.author);
+    }
+
+    static bool yearBefore(const Book& b, int year) { return b.year < year; }
+
+    void compactIfNeeded() {
+        size_t limit = max((size_t)32, (size_t)sqrt((double)run.size()));
+        if (added.size() + removed.size() <= limit) return;
+        vector<Book> merged;
+        merged.reserve(run.size() + added.size() - removed.size());
+        forEachInRange(INT_MIN, INT_MAX, [&](const Book& b) { merged.push_back(b); });
+        run.swap(merged);
+        added.clear();
+        removed.clear();
+    }
+
+public:
+    void insert(const Book& b) {
+        added.insert(upper_bound(added.begin(), added.end(), b, before), b);
+        compactIfNeeded();
+    }
+
+    // `b` must be in the index
+    void remove(const Book& b) {
+        auto it = lower_bound(added.begin(), added.end(), b, before);
+        if (it != added.end() && !before(b, *it)) {
+            added.erase(it);
+        } else {
+            removed.insert(upper_bound(removed.begin(), removed.end(), b, before), b);
+            compactIfNeeded();
+        }
+    }
+
+    size_t size() const { return run.size() + added.size() - removed.size(); }
+
+    // f(book) for every book with from <= year <= to, in year order
+    template <class F>
+    void forEachInRange(int from, int to, F f) const {
+        auto r = lower_bound(run.begin(), run.end(), from, yearBefore);
+        auto a = lower_bound(added.begin(), added.end(), from, yearBefore);
+        auto d = lower_bound(removed.begin(), removed.end(), from, yearBefore);
+        while (true) {
+            bool runLeft = r != run.end() && r->year <= to;
+            bool addedLeft = a != added.end() && a->year <= to;
+            if (!runLeft && !addedLeft) return;
+            if (addedLeft && (!runLeft || before(*a, *r))) {
+                f(*a++);
+                continue;
+            }
+            while (d != removed.end() && before(*d, *r)) d++;
+            if (d != removed.end() && !before(*r, *d)) {
+                d++;  // deleted: each removal hides one copy
+                r++;
+                continue;
+            }
+            f(*r++);
+        }
+    }
+};
+
+/* ================= ARRAY ADT ================= */
+class BookArray {
+private:
+    Book* arr;
+    int size;
+    int capacity;
+    YearIndex byYear;
+
+    void printBook(const Book& b, int number) {
+        cout << "\n📖 Book #" << number << "\n";
+        cout << "   ID:     " << b.id << endl;
+        cout << "   Title:  " << b.title << endl;
+        cout << "   Author: " << b.author << endl;
+        cout << "   Year:   " << b.year << endl;
+        cout << "   " << string(50, '-') << endl;
+    }
+
+public:
+    BookArray(int cap = 50) {
+        capacity = max(cap, 1);
+        size = 0;
+        arr = new Book[capacity];
+    }
+
+    int getSize() { return size; }
+
+    Book& get(int i) { return arr[i]; }
+
+    // Silent versions, used when replaying saved data. The array doubles
+    // when full, so a saved catalog of any size fits.
+    bool insertBook(const Book& b) {
+        if (size == capacity) {
+            capacity *= 2;
+            Book* bigger = new Book[capacity];
+            for (int i = 0; i < size; i++)
+                bigger[i] = move(arr[i]);
+            delete[] arr;
+            arr = bigger;
+        }
+        arr[size++] = b;
+        byYear.insert(b);
+        return true;
+    }
+
+    bool removeBook(int id) {
+        int i = searchBook(id);
+        if (i == -1) return false;
+        byYear.remove(arr[i]);
+        for (int j = i; j < size - 1; j++)
+            arr[j] = arr[j + 1];
+        size--;
+        return true;
+    }
+
+    bool addBook(Book b) {
+        insertBook(b);
+        cout << "\n✓ Book added successfully!\n";
+        return true;
+    }
+
+    bool deleteBook(int id) {
+        if (removeBook(id)) {
+            cout << "\n✓ Book deleted successfully!\n";
+            return true;
+        }
+        cout << "\n✗ Book not found!\n";
+        return false;
+    }
+
+    int searchBook(int id) {
+        for (int i = 0; i < size; i++)
+            if (arr[i].id == id)
+                return i;
+        return -1;
+    }
+
+    void displayBooks() {
+        if (size == 0) {
+            cout << "\n📚 No books available.\n";
+            return;
+        }
+        cout << "\n" << string(70, '=') << endl;
+        cout << "                      📚 LIBRARY COLLECTION\n";
+        cout << string(70, '=') << endl;
+        for (int i = 0; i < size; i++)
+            printBook(arr[i], i + 1);
+    }
+
+    // Books with from <= year <= to, oldest first, from the year index
+    // (the array keeps its insertion order)
+    void displayByYear(int from = INT_MIN, int to = INT_MAX) {
+        int count = 0;
+        byYear.forEachInRange(from, to, [&](const Book& b) {
+            if (count == 0) {
+                cout << "\n" << string(70, '=') << endl;
+                cout << "                      📅 BOOKS BY YEAR\n";
+                cout << string(70, '=') << endl;
+            }
+            printBook(b, ++count);
+        });
+        if (count == 0)
+            cout << "\n📚 No books found.\n";
+        else
+            cout << "\n✓ " << count << " book(s) found.\n";
+    }
+};
+
+/* ================= LINKED LIST (HISTORY) ================= */
+struct HistoryNode {
+    int userID;
+    int bookID;
+    HistoryNode* next;
+};
+
+class BorrowHistory {
+private:
+    HistoryNode* head;
+    BorrowStats stats;  // kept up to date by addHistory
+
+public:
+    BorrowHistory() {
+        head = NULL;
+    }
+
+    void addHistory(int user, int book) {
+        HistoryNode* node = new HistoryNode{ user, book, head };
+        head = node;
+        stats.record(user, book);
+    }
+
+    const BorrowStats& statistics() const { return stats; }
+
+    // f(userID, bookID) for every entry, newest first
+    template <class F>
+    void forEach(F f) {
+        for (HistoryNode* temp = head; temp; temp = temp->next)
+            f(temp->userID, temp->bookID);
+    }
+
+    void displayHistory() {
+        if (!head) {
+            cout << "\n📜 No borrowing history.\n";
+            return;
+        }
+        cout << "\n" << string(70, '=') << endl;
+        cout << "                   📜 BORROWING HISTORY\n";
+        cout << string(70, '=') << endl;
+        HistoryNode* temp = head;
+        int count = 1;
+        while (temp) {
+            cout << count++ << ". 👤 User " << temp->userID
+                << " borrowed 📖 Book ID " << temp->bookID << endl;
+            temp = temp->next;
+        }
+        cout << string(70, '=') << endl;
+    }
+};
+
+#endif
@@ -0,0 +1,422 @@
+#ifndef LIBRARY_ANALYTICS_H
+#define LIBRARY_ANALYTICS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <chrono>
+#include "library.h"
+using namespace std;
+
+/*
+ * "Readers who borrowed X also borrowed Y": for every book, the books
+ * most often borrowed by the same users, computed in one batch over the
+ * borrow history and kept in a compact table for lookups.
+ *
+ * build() runs in four parallel steps:
+ *   1. Events are split by user, so every user's borrows land on one
+ *      thread (in history order).
+ *   2. Each thread takes the distinct books of each of its users and
+ *      counts every pair of them (smaller ID first) in its own hash table.
+ *      Each count goes, once, to the thread of the smaller book.
+ *   3. There the counts of all threads are sorted and merged per pair.
+ *      Each book ranks its partners with larger IDs, and every merged
+ *      count goes on, reversed, to the thread of the larger book.
+ *   4. That thread adds the reversed counts to the ranking of the larger
+ *      book, so every book keeps its TOP_N partners from both sides.
+ *
+ * Counts travel as 12-byte records, the hash table frees its blocks as
+ * they are emptied into them, and the merges read the sorted lists of the
+ * threads side by side instead of copying them into one. Peak memory is
+ * about the hash tables, or 24 bytes per pair while steps 3 and 4 run.
+ *
+ * A user contributes each pair once however often they reread. Only the
+ * MAX_BOOKS_PER_USER most recent distinct books of a user are paired, so
+ * a few very heavy readers cannot blow up the pair count quadratically.
+ *
+ * The table is three arrays: the book IDs in order, where each book's
+ * list starts, and the lists themselves, so a lookup is a binary search.
+ */
+
+/* ================= PAIR COUNTER ================= */
+// Hash table from a book pair to a count, open addressing with linear
+// probing. Keys are (X << 32 | Y); X != Y, so all ones never occurs.
+// Key and count share a slot, so an add touches one cache line, and
+// addAll() prefetches the slots of upcoming keys while it works. Large
+// tables are split into blocks of BLOCK slots so drain() can free them as
+// it goes; at 64 MB a block is its own mapping, so freeing it returns the
+// memory to the system.
+class PairCounter {
+private:
+    static const uint64_t EMPTY = UINT64_MAX;
+    static const size_t PREFETCH = 16;  // keys ahead
+    static const int BLOCK_BITS = 22;
+    static const size_t BLOCK = (size_t)1 << BLOCK_BITS;
+
+    struct Slot {
+        uint64_t key;
+        uint64_t count;
+    };
+
+    vector<vector<Slot>> blocks;
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t mask = 0;
+
+    Slot& slot(size_t i) { return blocks[i >> BLOCK_BITS][i & (BLOCK - 1)]; }
+
+    static size_t hashOf(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return (size_t)key;
+    }
+
+    void grow() {
+        vector<vector<Slot>> old;
+        old.swap(blocks);
+        capacity = max((size_t)1024, capacity * 2);
+        size_t size = min(capacity, (size_t)BLOCK);
+        for (size_t n = 0; n < capacity; n += size) blocks.emplace_back(size, Slot{ EMPTY, 0 });
+        mask = capacity - 1;
+        used = 0;
+        for (vector<Slot>& block : old) {
+            for (const Slot& s : block)
+                if (s.key != EMPTY) add(s.key, s.count);
+            vector<Slot>().swap(block);
+        }
+    }
+
+public:
+    static uint64_t pair(int x, int y) { return (uint64_t)(uint32_t)x << 32 | (uint32_t)y; }
+    static int first(uint64_t key) { return (int)(uint32_t)(key >> 32); }
+    static int second(uint64_t key) { return (int)(uint32_t)key; }
+
+    void add(uint64_t key, uint64_t count) {
+        if ((used + 1) * 4 > capacity * 3) grow();  // stay under 3/4 full
+        size_t i = hashOf(key) & mask;
+        while (slot(i).key != EMPTY && slot(i).key != key) i = (i + 1) & mask;
+        Slot& s = slot(i);
+        if (s.key == EMPTY) {
+            s.key = key;
+            used++;
+        }
+        s.count += count;
+    }
+
+    // add(key, 1) for each of `n` keys
+    void addAll(const uint64_t* keys, size_t n) {
+        while ((used + n) * 4 > capacity * 3) grow();  // no growing in the loop
+        for (size_t k = 0; k < n; k++) {
+            if (k + PREFETCH < n) __builtin_prefetch(&slot(hashOf(keys[k + PREFETCH]) & mask));
+            add(keys[k], 1);
+        }
+    }
+
+    size_t size() const { return used; }
+
+    // f(key, count) for every pair
+    template <class F>
+    void forEach(F f) const {
+        for (const vector<Slot>& block : blocks)
+            for (const Slot& s : block)
+                if (s.key != EMPTY) f(s.key, s.count);
+    }
+
+    // forEach(), freeing each block once it is read;
+    // the counter is empty afterwards
+    template <class F>
+    void drain(F f) {
+        for (vector<Slot>& block : blocks) {
+            for (const Slot& s : block)
+                if (s.key != EMPTY) f(s.key, s.count);
+            vector<Slot>().swap(block);
+        }
+        blocks.clear();
+        capacity = used = mask = 0;
+    }
+};
+
+/* ================= CO-BORROW TABLE ================= */
+class CoBorrowTable {
+public:
+    static const int TOP_N = 10;
+    static const int MAX_BOOKS_PER_USER = 256;
+
+    struct Related {
+        int bookID;
+        uint32_t readers;  // users who borrowed both books
+    };
+
+private:
+    vector<int> bookIDs;      // sorted
+    vector<uint32_t> starts;  // list of bookIDs[i] is entries[starts[i], starts[i + 1])
+    vector<Related> entries;  // each list by readers, most first
+
+    // A count on its way to the list of `book`
+    struct PairCount {
+        int book;
+        int other;
+        uint32_t readers;
+    };
+
+    // Books with their ranked partners, ascending by book: lists[i] is the
+    // list of books[i].first and holds books[i].second entries
+    struct Ranking {
+        vector<pair<int, uint32_t>> books;
+        vector<Related> lists;
+    };
+
+    // Per thread, the records each thread sends it
+    typedef vector<vector<vector<PairCount>>> Exchange;
+
+    static size_t partOf(int key, unsigned parts) {
+        return (size_t)(((uint32_t)key * 2654435761u) >> 7) % parts;
+    }
+
+    static bool byPair(const PairCount& a, const PairCount& b) {
+        return a.book != b.book ? a.book < b.book : a.other < b.other;
+    }
+
+    template <class F>
+    static void runThreads(unsigned numThreads, F f) {
+        vector<thread> threads;
+        for (unsigned t = 0; t < numThreads; t++) threads.emplace_back(f, t);
+        for (thread& th : threads) th.join();
+    }
+
+    // Sorts the records every thread sent to `part` and walks them in
+    // (book, other) order, calling f(book, other, readers) once per pair
+    // with the counts of all threads added up; frees them afterwards
+    template <class F>
+    static void mergeCounts(Exchange& sent, unsigned part, F f) {
+        unsigned parts = sent.size();
+        vector<size_t> next(parts, 0);
+        vector<unsigned> heap;  // threads with records left, smallest next record on top
+        auto later = [&](unsigned a, unsigned b) { return byPair(sent[b][part][next[b]], sent[a][part][next[a]]); };
+        for (unsigned t = 0; t < parts; t++) {
+            sort(sent[t][part].begin(), sent[t][part].end(), byPair);
+            if (!sent[t][part].empty()) heap.push_back(t);
+        }
+        make_heap(heap.begin(), heap.end(), later);
+        while (!heap.empty()) {
+            PairCount merged = sent[heap.front()][part][next[heap.front()]];
+            merged.readers = 0;
+            // Equal pairs are the same pair from different threads
+            while (!heap.empty()) {
+                unsigned t = heap.front();
+                const PairCount& c = sent[t][part][next[t]];
+                if (c.book != merged.book || c.other != merged.other) break;
+                merged.readers += c.readers;
+                pop_heap(heap.begin(), heap.end(), later);
+                if (++next[t] < sent[t][part].size()) push_heap(heap.begin(), heap.end(), later);
+                else heap.pop_back();
+            }
+            f(merged.book, merged.other, merged.readers);
+        }
+        for (unsigned t = 0; t < parts; t++) vector<PairCount>().swap(sent[t][part]);
+    }
+
+    // Keeps the TOP_N of `candidates` as the list of `book`
+    static void rank(int book, vector<Related>& candidates, Ranking& out) {
+        size_t keep = min(candidates.size(), (size_t)TOP_N);
+        partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                     [](const Related& x, const Related& y) {
+                         return x.readers != y.readers ? x.readers > y.readers : x.bookID < y.bookID;
+                     });
+        out.books.push_back({ book, (uint32_t)keep });
+        out.lists.insert(out.lists.end(), candidates.begin(), candidates.begin() + keep);
+        candidates.clear();
+    }
+
+    // Step 2 for one thread: `events` sorted by user, history order kept
+    static void countPairs(const vector<pair<int, int>>& events, PairCounter& counter) {
+        vector<int> books;
+        vector<uint64_t> keys;
+        for (size_t begin = 0, end; begin < events.size(); begin = end) {
+            end = begin;
+            while (end < events.size() && events[end].first == events[begin].first) end++;
+
+            // Distinct books, most recent first, up to the cap
+            books.clear();
+            for (size_t i = end; i-- > begin && (int)books.size() < MAX_BOOKS_PER_USER;) {
+                if (find(books.begin(), books.end(), events[i].second) == books.end())
+                    books.push_back(events[i].second);
+            }
+            // Each pair once, smaller ID first
+            sort(books.begin(), books.end());
+            keys.clear();
+            for (size_t i = 0; i < books.size(); i++)
+                for (size_t j = i + 1; j < books.size(); j++)
+                    keys.push_back(PairCounter::pair(books[i], books[j]));
+            counter.addAll(keys.data(), keys.size());
+        }
+    }
+
+public:
+    // `events` are (userID, bookID) in history order, oldest first
+    void build(const vector<pair<int, int>>& events, unsigned numThreads = thread::hardware_concurrency()) {
+        unsigned parts = max(1u, numThreads);
+
+        // 1. Split by user: chunk t of the events goes to byUser[t][p]
+        vector<vector<vector<pair<int, int>>>> byUser(parts, vector<vector<pair<int, int>>>(parts));
+        runThreads(parts, [&](unsigned t) {
+            size_t begin = events.size() * t / parts, end = events.size() * (t + 1) / parts;
+            for (size_t i = begin; i < end; i++) byUser[t][partOf(events[i].first, parts)].push_back(events[i]);
+        });
+
+        // 2. Count pairs per part, then send each count to the smaller book
+        Exchange toSmaller(parts, vector<vector<PairCount>>(parts));
+        runThreads(parts, [&](unsigned p) {
+            vector<pair<int, int>> mine;
+            for (unsigned t = 0; t < parts; t++) {
+                mine.insert(mine.end(), byUser[t][p].begin(), byUser[t][p].end());
+                vector<pair<int, int>>().swap(byUser[t][p]);
+            }
+            stable_sort(mine.begin(), mine.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+                return a.first < b.first;
+            });
+            PairCounter counter;
+            countPairs(mine, counter);
+            vector<pair<int, int>>().swap(mine);
+            // Sized first, so no list grows by copying while the counter is full
+            vector<size_t> sizes(parts, 0);
+            counter.forEach([&](uint64_t key, uint64_t) { sizes[partOf(PairCounter::first(key), parts)]++; });
+            for (unsigned q = 0; q < parts; q++) toSmaller[p][q].reserve(sizes[q]);
+            counter.drain([&](uint64_t key, uint64_t count) {
+                int x = PairCounter::first(key), y = PairCounter::second(key);
+                toSmaller[p][partOf(x, parts)].push_back({ x, y, (uint32_t)count });
+            });
+        });
+
+        // 3. Merge the counts of each pair, rank each book's partners with
+        //    larger IDs and send the merged counts on to the larger book
+        Exchange toLarger(parts, vector<vector<PairCount>>(parts));
+        vector<Ranking> smaller(parts);
+        runThreads(parts, [&](unsigned p) {
+            vector<Related> candidates;
+            int book = 0;
+            mergeCounts(toSmaller, p, [&](int x, int y, uint32_t readers) {
+                if (!candidates.empty() && x != book) rank(book, candidates, smaller[p]);
+                book = x;
+                candidates.push_back({ y, readers });
+                toLarger[p][partOf(y, parts)].push_back({ y, x, readers });
+            });
+            if (!candidates.empty()) rank(book, candidates, smaller[p]);
+        });
+
+        // 4. Rank every book's partners from both sides: the reversed
+        //    counts plus the lists from step 3, both in book order
+        vector<Ranking> ranked(parts);
+        runThreads(parts, [&](unsigned p) {
+            const Ranking& first = smaller[p];
+            size_t next = 0, from = 0;  // in first.books and first.lists
+            vector<Related> candidates;
+            auto takeFirst = [&]() {
+                candidates.insert(candidates.end(), first.lists.begin() + from,
+                                  first.lists.begin() + from + first.books[next].second);
+                from += first.books[next++].second;
+            };
+            int book = 0;
+            mergeCounts(toLarger, p, [&](int y, int x, uint32_t readers) {
+                if (!candidates.empty() && y != book) rank(book, candidates, ranked[p]);
+                while (next < first.books.size() && first.books[next].first < y) {
+                    int only = first.books[next].first;
+                    takeFirst();
+                    rank(only, candidates, ranked[p]);
+                }
+                if (candidates.empty() && next < first.books.size() && first.books[next].first == y) takeFirst();
+                book = y;
+                candidates.push_back({ x, readers });
+            });
+            if (!candidates.empty()) rank(book, candidates, ranked[p]);
+            while (next < first.books.size()) {
+                int only = first.books[next].first;
+                takeFirst();
+                rank(only, candidates, ranked[p]);
+            }
+        });
+
+        // Lay the parts out as one table ordered by book ID
+        vector<pair<int, pair<unsigned, pair<uint32_t, uint32_t>>>> order;  // book, (part, (start, length))
+        for (unsigned p = 0; p < parts; p++) {
+            uint32_t start = 0;
+            for (auto& b : ranked[p].books) {
+                order.push_back({ b.first, { p, { start, b.second } } });
+                start += b.second;
+            }
+        }
+        sort(order.begin(), order.end());
+        bookIDs.clear();
+        starts.assign(1, 0);
+        entries.clear();
+        for (auto& o : order) {
+            const vector<Related>& list = ranked[o.second.first].lists;
+            uint32_t start = o.second.second.first, length = o.second.second.second;
+            bookIDs.push_back(o.first);
+            entries.insert(entries.end(), list.begin() + start, list.begin() + start + length);
+            starts.push_back(entries.size());
+        }
+    }
+
+    void build(BorrowHistory& history, unsigned numThreads = thread::hardware_concurrency()) {
+        vector<pair<int, int>> events;
+        history.forEach([&](int user, int book) { events.push_back({ user, book }); });
+        reverse(events.begin(), events.end());  // history is kept newest first
+        build(events, numThreads);
+    }
+
+    // Books most often borrowed together with `bookID`; returns how many
+    // (up to TOP_N) and points `list` at them
+    int related(int bookID, const Related*& list) const {
+        auto it = lower_bound(bookIDs.begin(), bookIDs.end(), bookID);
+        if (it == bookIDs.end() || *it != bookID) return 0;
+        size_t i = it - bookIDs.begin();
+        list = &entries[starts[i]];
+        return starts[i + 1] - starts[i];
+    }
+
+    size_t bookCount() const { return bookIDs.size(); }
+};
+
+/* ================= BENCHMARK ================= */
+// Builds the table from `numEvents` made-up borrows (one user per 20
+// events, popular books borrowed far more often) and prints the timing
+inline int runCoBorrowBenchmark(uint64_t numEvents, unsigned numThreads) {
+    const int books = 100000;
+    int users = max<uint64_t>(1, numEvents / 20);
+    vector<pair<int, int>> events(numEvents);
+    uint64_t state = 88172645463325252ULL;
+    for (auto& e : events) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double r = (double)(state >> 11) / (double)(1ULL << 53);
+        e = { (int)(state % users), (int)(r * r * r * books) };
+    }
+
+    auto begin = chrono::steady_clock::now();
+    CoBorrowTable table;
+    table.build(events, numThreads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    const CoBorrowTable::Related* list = NULL;
+    int n = table.related(0, list);
+    cout << "\n" << string(50, '=') << endl;
+    cout << "     🤝 CO-BORROW BUILD\n";
+    cout << string(50, '=') << endl;
+    cout << "   Events:      " << numEvents << " from " << users << " users" << endl;
+    cout << "   Threads:     " << numThreads << endl;
+    cout << "   Time:        " << seconds << " s (" << (uint64_t)(numEvents / seconds) << " events/s)" << endl;
+    cout << "   Books:       " << table.bookCount() << " with related lists" << endl;
+    cout << "   Book 0:      ";
+    for (int i = 0; i < n; i++) cout << list[i].bookID << " (" << list[i].readers << ") ";
+    cout << endl << string(50, '=') << endl;
+    return 0;
+}
+
+#endif
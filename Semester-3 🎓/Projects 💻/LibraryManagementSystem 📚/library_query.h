@@ -0,0 +1,273 @@
+#ifndef LIBRARY_QUERY_H
+#define LIBRARY_QUERY_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include "library.h"
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+using namespace std;
+
+/*
+ * Reports over the catalog ("books per decade by author X", "books from
+ * 1950 to 1999") on a column-per-field copy of the books:
+ *
+ *   ids, years    one int32 array each
+ *   authors       one uint32 code per book, names kept once in a dictionary
+ *   decades       the same for the decade of the year, for grouping
+ *
+ * A query filters on ranges of id and year and on one author, then counts
+ * the matches, overall or grouped by decade or by author. Rows are
+ * checked 64 at a time: each predicate compares 8 (AVX2) or 4 (SSE2)
+ * values per instruction and yields one bit per row, the bits of all
+ * predicates are ANDed, and the set bits become a selection vector of row
+ * numbers that the grouping reads. Counting without groups only needs the
+ * number of bits. Predicates left open are skipped.
+ *
+ * The rows are split into equal parts, one per thread; every thread keeps
+ * its own counts and they are added up at the end.
+ */
+
+/* ================= QUERY ================= */
+struct CatalogQuery {
+    enum GroupBy { NONE, DECADE, AUTHOR };
+
+    int minId = INT_MIN, maxId = INT_MAX;
+    int minYear = INT_MIN, maxYear = INT_MAX;
+    string author;  // empty for any author
+    GroupBy groupBy = NONE;
+};
+
+struct QueryResult {
+    uint64_t matched = 0;
+    vector<pair<string, uint64_t>> groups;  // label and count, in label order; no empty groups
+};
+
+/* ================= COLUMNAR CATALOG ================= */
+class ColumnarCatalog {
+private:
+    static const int BLOCK = 64;  // rows per predicate mask
+
+    vector<int32_t> ids;
+    vector<int32_t> years;
+    vector<uint32_t> authors;
+    vector<uint32_t> decades;
+    vector<string> authorNames;  // by code
+    unordered_map<string, uint32_t> authorCodes;
+    vector<int> decadeYears;     // first year of the decade, by code
+    unordered_map<int, uint32_t> decadeCodes;
+
+    // Bit r set if lo <= column[r] <= hi, for the n <= 64 rows at column
+    static uint64_t rangeMask(const int32_t* column, int n, int lo, int hi) {
+        uint64_t mask = 0;
+        int r = 0;
+#if defined(__AVX2__)
+        __m256i low = _mm256_set1_epi32(lo), high = _mm256_set1_epi32(hi);
+        for (; r + 8 <= n; r += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(column + r));
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low, x), _mm256_cmpgt_epi32(x, high));
+            uint32_t bits = ~(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xff;
+            mask |= (uint64_t)bits << r;
+        }
+#elif defined(__SSE2__)
+        __m128i low = _mm_set1_epi32(lo), high = _mm_set1_epi32(hi);
+        for (; r + 4 <= n; r += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(column + r));
+            __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(low, x), _mm_cmpgt_epi32(x, high));
+            uint32_t bits = ~(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xf;
+            mask |= (uint64_t)bits << r;
+        }
+#endif
+        for (; r < n; r++)
+            if (column[r] >= lo && column[r] <= hi) mask |= 1ULL << r;
+        return mask;
+    }
+
+    // Bit r set if column[r] == value
+    static uint64_t equalMask(const uint32_t* column, int n, uint32_t value) {
+        uint64_t mask = 0;
+        int r = 0;
+#if defined(__AVX2__)
+        __m256i v = _mm256_set1_epi32((int)value);
+        for (; r + 8 <= n; r += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(column + r));
+            uint32_t bits = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, v)));
+            mask |= (uint64_t)bits << r;
+        }
+#elif defined(__SSE2__)
+        __m128i v = _mm_set1_epi32((int)value);
+        for (; r + 4 <= n; r += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(column + r));
+            uint32_t bits = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, v)));
+            mask |= (uint64_t)bits << r;
+        }
+#endif
+        for (; r < n; r++)
+            if (column[r] == value) mask |= 1ULL << r;
+        return mask;
+    }
+
+    // Counts of rows [begin, end) that pass the query: groups[key]++ for
+    // grouped queries, otherwise just the total
+    void scan(const CatalogQuery& q, bool anyAuthor, uint32_t author, size_t begin, size_t end,
+              uint64_t& matched, vector<uint64_t>& groups) const {
+        bool byId = q.minId != INT_MIN || q.maxId != INT_MAX;
+        bool byYear = q.minYear != INT_MIN || q.maxYear != INT_MAX;
+        uint32_t selection[BLOCK];
+
+        for (size_t start = begin; start < end; start += BLOCK) {
+            int n = (int)min((size_t)BLOCK, end - start);
+            uint64_t mask = n == BLOCK ? ~0ULL : (1ULL << n) - 1;
+            if (byYear) mask &= rangeMask(&years[start], n, q.minYear, q.maxYear);
+            if (byId && mask) mask &= rangeMask(&ids[start], n, q.minId, q.maxId);
+            if (!anyAuthor && mask) mask &= equalMask(&authors[start], n, author);
+            if (!mask) continue;
+
+            if (q.groupBy == CatalogQuery::NONE) {
+                matched += __builtin_popcountll(mask);
+                continue;
+            }
+            int selected = 0;
+            for (; mask; mask &= mask - 1) selection[selected++] = (uint32_t)(start + __builtin_ctzll(mask));
+            matched += selected;
+            const uint32_t* keys = q.groupBy == CatalogQuery::DECADE ? decades.data() : authors.data();
+            for (int i = 0; i < selected; i++) groups[keys[selection[i]]]++;
+        }
+    }
+
+public:
+    void clear() {
+        ids.clear();
+        years.clear();
+        authors.clear();
+        authorNames.clear();
+        authorCodes.clear();
+        decades.clear();
+        decadeYears.clear();
+        decadeCodes.clear();
+    }
+
+    void append(const Book& b) {
+        auto code = authorCodes.emplace(b.author, (uint32_t)authorNames.size());
+        if (code.second) authorNames.push_back(b.author);
+        ids.push_back(b.id);
+        years.push_back(b.year);
+        authors.push_back(code.first->second);
+        int decade = (b.year >= 0 ? b.year : b.year - 9) / 10 * 10;
+        auto decadeCode = decadeCodes.emplace(decade, (uint32_t)decadeYears.size());
+        if (decadeCode.second) decadeYears.push_back(decade);
+        decades.push_back(decadeCode.first->second);
+    }
+
+    void build(BookArray& library) {
+        clear();
+        for (int i = 0; i < library.getSize(); i++) append(library.get(i));
+    }
+
+    size_t size() const { return ids.size(); }
+
+    QueryResult run(const CatalogQuery& q, unsigned numThreads = thread::hardware_concurrency()) const {
+        QueryResult result;
+        bool anyAuthor = q.author.empty();
+        uint32_t author = 0;
+        if (!anyAuthor) {
+            auto it = authorCodes.find(q.author);
+            if (it == authorCodes.end()) return result;  // no book has this author
+            author = it->second;
+        }
+        size_t groupCount = q.groupBy == CatalogQuery::DECADE ? decadeYears.size()
+                          : q.groupBy == CatalogQuery::AUTHOR ? authorNames.size() : 0;
+
+        // Parts start on a block boundary; small catalogs use one thread
+        unsigned parts = max(1u, min(numThreads, (unsigned)(ids.size() / 65536 + 1)));
+        size_t blocks = (ids.size() + BLOCK - 1) / BLOCK;
+        vector<uint64_t> matched(parts, 0);
+        vector<vector<uint64_t>> groups(parts, vector<uint64_t>(groupCount, 0));
+        vector<thread> threads;
+        for (unsigned t = 0; t < parts; t++) {
+            size_t begin = min(ids.size(), blocks * t / parts * BLOCK);
+            size_t end = min(ids.size(), blocks * (t + 1) / parts * BLOCK);
+            auto work = [&, t, begin, end] { scan(q, anyAuthor, author, begin, end, matched[t], groups[t]); };
+            if (t + 1 == parts) work();  // the calling thread takes the last part
+            else threads.emplace_back(work);
+        }
+        for (thread& th : threads) th.join();
+
+        for (unsigned t = 0; t < parts; t++) {
+            result.matched += matched[t];
+            if (t > 0)
+                for (size_t g = 0; g < groupCount; g++) groups[0][g] += groups[t][g];
+        }
+        if (q.groupBy == CatalogQuery::AUTHOR) {
+            for (size_t g = 0; g < groupCount; g++)
+                if (groups[0][g]) result.groups.push_back({ authorNames[g], groups[0][g] });
+            sort(result.groups.begin(), result.groups.end());
+        } else if (q.groupBy == CatalogQuery::DECADE) {
+            vector<pair<int, uint64_t>> byDecade;
+            for (size_t g = 0; g < groupCount; g++)
+                if (groups[0][g]) byDecade.push_back({ decadeYears[g], groups[0][g] });
+            sort(byDecade.begin(), byDecade.end());
+            for (auto& d : byDecade) result.groups.push_back({ to_string(d.first) + "s", d.second });
+        }
+        return result;
+    }
+};
+
+/* ================= BENCHMARK ================= */
+// Runs a few reports over `numBooks` made-up books and prints rows/s
+inline int runQueryBenchmark(uint64_t numBooks, unsigned numThreads) {
+    ColumnarCatalog catalog;
+    uint64_t state = 0x2545f4914f6cdd1dULL;
+    Book b{ 0, "", "", 0 };
+    vector<string> names;
+    for (int a = 0; a < 1000; a++) names.push_back("Author " + to_string(a));
+    for (uint64_t i = 0; i < numBooks; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        b.id = (int)i;
+        b.year = 1800 + (int)(state % 225);
+        b.author = names[(state >> 16) % names.size()];
+        catalog.append(b);
+    }
+
+    CatalogQuery yearRange;
+    yearRange.minYear = 1950;
+    yearRange.maxYear = 1999;
+    CatalogQuery decadesByAuthor;
+    decadesByAuthor.author = "Author 7";
+    decadesByAuthor.groupBy = CatalogQuery::DECADE;
+    CatalogQuery perAuthor;
+    perAuthor.minYear = 2000;
+    perAuthor.groupBy = CatalogQuery::AUTHOR;
+    pair<const char*, CatalogQuery> queries[] = {
+        { "count, 1950 <= year <= 1999", yearRange },
+        { "per decade, author = X     ", decadesByAuthor },
+        { "per author, year >= 2000   ", perAuthor },
+    };
+
+    cout << "\n" << string(60, '=') << endl;
+    cout << "     🧮 CATALOG QUERIES over " << numBooks << " books, " << numThreads << " thread(s)\n";
+    cout << string(60, '=') << endl;
+    for (auto& query : queries) {
+        const int runs = 5;
+        QueryResult result;
+        auto begin = chrono::steady_clock::now();
+        for (int r = 0; r < runs; r++) result = catalog.run(query.second, numThreads);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count() / runs;
+        cout << "   " << query.first << "  " << result.matched << " matches, "
+             << (uint64_t)(numBooks / seconds / 1e6) << " M rows/s" << endl;
+    }
+    cout << string(60, '=') << endl;
+    return 0;
+}
+
+#endif
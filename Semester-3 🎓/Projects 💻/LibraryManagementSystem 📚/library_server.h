@@ -0,0 +1,747 @@
+#ifndef LIBRARY_SERVER_H
+#define LIBRARY_SERVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <queue>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "library.h"
+#include "library_storage.h"
+using namespace std;
+
+/*
+ * Server mode: many local clients share one library over a Unix socket
+ * ("unix:PATH") or loopback TCP ("tcp:PORT").
+ *
+ * Protocol: one request per line, fields separated by tabs, one reply
+ * line per request ("OK ..." or "ERR ..."). Clients may send several
+ * requests before reading the replies.
+ *   ADD <id> <title> <author> <year>     DEL <id>     GET <id>
+ *   COUNT               QUIT
+ *   BORROW <userID> <bookID>   "OK lent", or "OK waiting <position>"
+ *                       when the book is out and the user is put on
+ *                       its waitlist
+ *   RETURN <bookID>     "OK available", or "OK lent <userID>" when the
+ *                       next user on the waitlist gets the book
+ *   ACTIVITY <userID>   approximate borrows by the user
+ *   STATS               total borrows, distinct readers, then
+ *                       book:borrows of the 10 most borrowed books
+ *
+ * The catalog is split into shards by book ID, each behind its own
+ * reader-writer lock, so lookups run in parallel and an add, delete or
+ * borrow only blocks its own shard. Loans go through the same Waitlists
+ * (slab-pooled holds) and requestLoan()/returnLoan() as the menu, under
+ * one mutex together with the BorrowHistory, so the history stays a
+ * single ordered list and a data directory can be used by either mode.
+ *
+ * One thread waits on every connection at once with epoll. When a
+ * connection has requests, that connection goes to a fixed ThreadPool as
+ * one task: the worker reads what has arrived, answers it and hands the
+ * connection back (EPOLLONESHOT, so only one worker has it at a time).
+ * Idle clients cost no worker, and any number of clients share the
+ * pool.
+ *
+ * With a data directory every change is also written to the log of
+ * library_storage.h, and its reply waits until the change is on disk. A
+ * change the log could not take is answered with "OK unsaved": it was
+ * made and others see it, but it reaches the disk only with a later
+ * write that succeeds. "ERR" always means nothing changed.
+ */
+
+/* ================= SHARDED CATALOG ================= */
+class ShardedCatalog {
+public:
+    static const int SHARDS = 64;
+
+private:
+    struct Shard {
+        shared_mutex lock;
+        unordered_map<int, Book> books;
+    };
+
+    Shard shards[SHARDS];
+    mutex historyLock;
+    BorrowHistory history;
+    Waitlists holds;  // under historyLock
+    LibraryStorage* storage = NULL;
+    atomic<bool> snapshotting{ false };
+
+    Shard& shardOf(int id) { return shards[(unsigned)id % SHARDS]; }
+
+    // Queues a change for the log while its shard is still locked, so the
+    // log order matches the order the changes were made in; 0 without storage
+    uint64_t log(const LogRecord& r) { return storage ? storage->append(r) : 0; }
+
+    // Waits (with the shard unlocked) until the change is on disk, or
+    // leaves that to the caller when it passed `deferred`
+    void commit(uint64_t sequence, uint64_t* deferred) {
+        if (deferred) *deferred = max(*deferred, sequence);
+        else waitDurable(sequence);
+    }
+
+    // Changes stop only while the state is copied, not while it is written
+    void takeSnapshot() {
+        vector<LogRecord> state;
+        uint64_t g;
+        {
+            vector<unique_lock<shared_mutex>> held;
+            for (Shard& shard : shards) held.emplace_back(shard.lock);
+            lock_guard<mutex> historyGuard(historyLock);
+            g = storage->beginSnapshot();
+            for (Shard& shard : shards)
+                for (auto& entry : shard.books) state.push_back(LogRecord::add(entry.second));
+            size_t books = state.size();
+            history.forEach([&](int user, int book) { state.push_back(LogRecord::borrow(user, book)); });
+            reverse(state.begin() + books, state.end());
+            appendHolds(state, holds);
+        }
+        if (!storage->writeSnapshot(g, state)) cerr << "\n✗ Snapshot failed.\n";
+    }
+
+public:
+    // Logs every change to `s` from now on. Replies are sent only once the
+    // change is on disk, though other clients may see it slightly earlier.
+    void attach(LibraryStorage* s) { storage = s; }
+
+    // Returns once change `sequence` (and all before it) is on disk, false
+    // if it could not be written; takes a snapshot when one is due
+    bool waitDurable(uint64_t sequence) {
+        if (!sequence) return true;
+        if (!storage->waitDurable(sequence)) return false;
+        if (storage->snapshotDue() && !snapshotting.exchange(true)) {
+            takeSnapshot();
+            snapshotting = false;
+        }
+        return true;
+    }
+
+    bool isSaved(uint64_t sequence) { return !sequence || storage->isDurable(sequence); }
+
+    // Replays a saved change, before clients connect
+    void apply(const LogRecord& r) {
+        if (r.type == 'A') shardOf(r.book.id).books.emplace(r.book.id, r.book);
+        else if (r.type == 'D') shardOf(r.book.id).books.erase(r.book.id);
+        replayLoans(r, holds, history);
+    }
+
+    // Changes take `deferred` to batch the disk wait for several requests:
+    // the newest sequence number is kept there for waitDurable()
+
+    // False if a book with this ID exists already
+    bool addBook(const Book& b, uint64_t* deferred = NULL) {
+        Shard& shard = shardOf(b.id);
+        uint64_t sequence;
+        {
+            unique_lock<shared_mutex> guard(shard.lock);
+            if (!shard.books.emplace(b.id, b).second) return false;
+            sequence = log(LogRecord::add(b));
+        }
+        commit(sequence, deferred);
+        return true;
+    }
+
+    bool deleteBook(int id, uint64_t* deferred = NULL) {
+        Shard& shard = shardOf(id);
+        uint64_t sequence;
+        {
+            unique_lock<shared_mutex> guard(shard.lock);
+            if (!shard.books.erase(id)) return false;
+            {
+                lock_guard<mutex> historyGuard(historyLock);
+                holds.removeBook(id);  // as replaying the delete would
+            }
+            sequence = log(LogRecord::remove(id));
+        }
+        commit(sequence, deferred);
+        return true;
+    }
+
+    bool findBook(int id, Book& b) {
+        Shard& shard = shardOf(id);
+        shared_lock<shared_mutex> guard(shard.lock);
+        auto it = shard.books.find(id);
+        if (it == shard.books.end()) return false;
+        b = it->second;
+        return true;
+    }
+
+    static const int NOT_FOUND = INT_MIN + 1;  // borrowBook(): no such book
+
+    // The book stays locked until the loan is decided and logged, so it
+    // cannot be deleted halfway. Returns what requestLoan() does, or
+    // NOT_FOUND; only a loan or a place on the waitlist is logged.
+    int borrowBook(int user, int id, uint64_t* deferred = NULL) {
+        Shard& shard = shardOf(id);
+        uint64_t sequence = 0;
+        int result;
+        {
+            unique_lock<shared_mutex> guard(shard.lock);
+            if (!shard.books.count(id)) return NOT_FOUND;
+            lock_guard<mutex> historyGuard(historyLock);
+            result = requestLoan(holds, history, user, id);
+            if (result == Waitlists::LENT || result > 0) sequence = log(LogRecord::request(user, id));
+        }
+        commit(sequence, deferred);
+        return result;
+    }
+
+    // False if the book is not on loan; `next` gets the user it goes to,
+    // or Waitlists::NONE
+    bool returnBook(int id, int& next, uint64_t* deferred = NULL) {
+        Shard& shard = shardOf(id);
+        uint64_t sequence;
+        {
+            unique_lock<shared_mutex> guard(shard.lock);
+            lock_guard<mutex> historyGuard(historyLock);
+            if (!returnLoan(holds, history, id, next)) return false;
+            sequence = log(LogRecord::giveBack(id));
+        }
+        commit(sequence, deferred);
+        return true;
+    }
+
+    string statistics() {
+        lock_guard<mutex> historyGuard(historyLock);
+        const BorrowStats& stats = history.statistics();
+        string line = to_string(stats.totalBorrows()) + "\t" + to_string(stats.distinctUsers()) + "\t";
+        const vector<TopBooks::Entry>& top = stats.popularBooks().top();
+        for (size_t i = 0; i < top.size() && i < 10; i++)
+            line += (i ? "," : "") + to_string(top[i].bookID) + ":" + to_string(top[i].count);
+        return line;
+    }
+
+    uint32_t userBorrows(int user) {
+        lock_guard<mutex> historyGuard(historyLock);
+        return history.statistics().userBorrows(user);
+    }
+
+    size_t count() {
+        size_t total = 0;
+        for (Shard& shard : shards) {
+            shared_lock<shared_mutex> guard(shard.lock);
+            total += shard.books.size();
+        }
+        return total;
+    }
+};
+
+/* ================= THREAD POOL ================= */
+class ThreadPool {
+private:
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutex lock;
+    condition_variable ready;
+    bool stopping = false;
+
+public:
+    ThreadPool(unsigned numThreads) {
+        for (unsigned i = 0; i < max(1u, numThreads); i++) {
+            workers.emplace_back([this] {
+                while (true) {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> guard(lock);
+                        ready.wait(guard, [this] { return stopping || !tasks.empty(); });
+                        if (tasks.empty()) return;  // stopping and drained
+                        task = move(tasks.front());
+                        tasks.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (thread& w : workers) w.join();
+    }
+
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> guard(lock);
+            tasks.push(move(task));
+        }
+        ready.notify_one();
+    }
+};
+
+/* ================= SOCKETS ================= */
+// Address from "unix:PATH" or "tcp:PORT"; false (with a message) if bad
+inline bool parseAddress(const string& spec, sockaddr_storage& address, socklen_t& length) {
+    memset(&address, 0, sizeof(address));
+    if (spec.compare(0, 5, "unix:") == 0) {
+        sockaddr_un* un = (sockaddr_un*)&address;
+        string path = spec.substr(5);
+        if (path.empty() || path.size() >= sizeof(un->sun_path)) {
+            cout << "\n✗ Socket path is empty or too long.\n";
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, path.c_str());
+        length = sizeof(sockaddr_un);
+        return true;
+    }
+    if (spec.compare(0, 4, "tcp:") == 0) {
+        int port = atoi(spec.c_str() + 4);
+        if (port <= 0 || port > 65535) {
+            cout << "\n✗ Bad TCP port.\n";
+            return false;
+        }
+        sockaddr_in* in = (sockaddr_in*)&address;
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)port);
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        length = sizeof(sockaddr_in);
+        return true;
+    }
+    cout << "\n✗ Address must be unix:PATH or tcp:PORT.\n";
+    return false;
+}
+
+inline int openListener(const string& spec) {
+    sockaddr_storage address;
+    socklen_t length;
+    if (!parseAddress(spec, address, length)) return -1;
+    int fd = socket(address.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (address.ss_family == AF_UNIX) {
+        unlink(((sockaddr_un*)&address)->sun_path);  // left over from an earlier run
+    } else {
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    }
+    if (::bind(fd, (sockaddr*)&address, length) < 0 || listen(fd, 128) < 0) {
+        cout << "\n✗ Cannot listen on " << spec << ": " << strerror(errno) << "\n";
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+inline int connectTo(const string& spec) {
+    sockaddr_storage address;
+    socklen_t length;
+    if (!parseAddress(spec, address, length)) return -1;
+    int fd = socket(address.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&address, length) < 0) {
+        cout << "\n✗ Cannot connect to " << spec << ": " << strerror(errno) << "\n";
+        close(fd);
+        return -1;
+    }
+    if (address.ss_family == AF_INET) {
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+// Waits for room on non-blocking sockets too
+inline bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd writable{ fd, POLLOUT, 0 };
+            poll(&writable, 1, -1);
+            continue;
+        }
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// Reads whole lines from a socket, buffering what arrives after them
+class LineReader {
+private:
+    int fd;
+    string buffer;
+    size_t start = 0;
+
+public:
+    LineReader(int socket) : fd(socket) {}
+
+    // A whole line from what was received already; false if there is none
+    bool nextLine(string& line) {
+        size_t end = buffer.find('\n', start);
+        if (end == string::npos) return false;
+        line.assign(buffer, start, end - start);
+        start = end + 1;
+        return true;
+    }
+
+    // One recv() into the buffer: bytes read, 0 at the end, -1 on error
+    // (errno EAGAIN when a non-blocking socket has nothing more)
+    ssize_t receive() {
+        buffer.erase(0, start);
+        start = 0;
+        char chunk[16384];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n > 0) buffer.append(chunk, n);
+        return n;
+    }
+
+    // Blocks until a whole line is there
+    bool readLine(string& line) {
+        while (!nextLine(line))
+            if (receive() <= 0) return false;
+        return true;
+    }
+};
+
+/* ================= SERVER ================= */
+class LibraryServer {
+private:
+    // A client's state between two turns on a worker
+    struct Connection {
+        int fd;
+        LineReader reader;
+        Connection(int socket) : fd(socket), reader(socket) {}
+    };
+
+    ShardedCatalog catalog;
+    unique_ptr<LibraryStorage> storage;  // set by openStorage()
+    int events = -1;                     // epoll instance
+
+    static vector<string> splitFields(const string& line) {
+        vector<string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t tab = line.find('\t', start);
+            fields.push_back(line.substr(start, tab - start));
+            if (tab == string::npos) return fields;
+            start = tab + 1;
+        }
+    }
+
+    // False for QUIT
+    // Changes are not on disk yet: `unsaved` gets the sequence number to
+    // wait for before the reply goes out
+    bool handle(const string& line, string& reply, uint64_t& unsaved) {
+        vector<string> f = splitFields(line);
+        const string& op = f[0];
+        if (op == "GET" && f.size() == 2) {
+            Book b;
+            if (!catalog.findBook(atoi(f[1].c_str()), b)) reply += "ERR not found\n";
+            else reply += "OK\t" + to_string(b.id) + "\t" + b.title + "\t" + b.author + "\t" + to_string(b.year) + "\n";
+        } else if (op == "ADD" && f.size() == 5) {
+            Book b{ atoi(f[1].c_str()), f[2], f[3], atoi(f[4].c_str()) };
+            reply += catalog.addBook(b, &unsaved) ? "OK\n" : "ERR duplicate id\n";
+        } else if (op == "DEL" && f.size() == 2) {
+            reply += catalog.deleteBook(atoi(f[1].c_str()), &unsaved) ? "OK\n" : "ERR not found\n";
+        } else if (op == "BORROW" && f.size() == 3) {
+            int result = catalog.borrowBook(atoi(f[1].c_str()), atoi(f[2].c_str()), &unsaved);
+            if (result == ShardedCatalog::NOT_FOUND) reply += "ERR not found\n";
+            else if (result == Waitlists::ALREADY_LENT) reply += "ERR already lent to this user\n";
+            else if (result == Waitlists::FULL) reply += "ERR waitlist full\n";
+            else if (result == Waitlists::LENT) reply += "OK\tlent\n";
+            else reply += "OK\twaiting\t" + to_string(result) + "\n";
+        } else if (op == "RETURN" && f.size() == 2) {
+            int next;
+            if (!catalog.returnBook(atoi(f[1].c_str()), next, &unsaved)) reply += "ERR not on loan\n";
+            else if (next == Waitlists::NONE) reply += "OK\tavailable\n";
+            else reply += "OK\tlent\t" + to_string(next) + "\n";
+        } else if (op == "STATS") {
+            reply += "OK\t" + catalog.statistics() + "\n";
+        } else if (op == "ACTIVITY" && f.size() == 2) {
+            reply += "OK\t" + to_string(catalog.userBorrows(atoi(f[1].c_str()))) + "\n";
+        } else if (op == "COUNT") {
+            reply += "OK\t" + to_string(catalog.count()) + "\n";
+        } else if (op == "QUIT") {
+            return false;
+        } else {
+            reply += "ERR bad request\n";
+        }
+        return true;
+    }
+
+    // The "OK" of every change in `reply` that did not reach the disk
+    // becomes "OK unsaved" (its other fields stay); `changes` has where
+    // each one starts and its sequence
+    string markUnsaved(const string& reply, const vector<pair<size_t, uint64_t>>& changes) {
+        string marked;
+        size_t copied = 0;
+        for (const pair<size_t, uint64_t>& change : changes) {
+            if (catalog.isSaved(change.second)) continue;
+            marked.append(reply, copied, change.first - copied);
+            marked += "OK unsaved";
+            copied = change.first + 2;  // past "OK"
+        }
+        marked.append(reply, copied, string::npos);
+        return marked;
+    }
+
+    // One turn of a connection on a worker: reads what has arrived (up to
+    // 64 KB, so a busy client cannot keep the worker), answers every whole
+    // request in one write after one wait for their changes to reach the
+    // disk, and gives the connection back to epoll
+    void serveReady(Connection* c) {
+        string line, reply;
+        vector<pair<size_t, uint64_t>> changes;
+        uint64_t unsaved = 0;
+        bool open = true;
+        size_t received = 0;
+        while (received < 65536) {
+            ssize_t n = c->reader.receive();
+            if (n > 0) {
+                received += n;
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) open = false;
+            if (n == 0 || errno != EINTR) break;
+        }
+        while (c->reader.nextLine(line)) {
+            size_t at = reply.size();
+            uint64_t before = unsaved;
+            if (!handle(line, reply, unsaved)) {
+                open = false;
+                break;
+            }
+            if (unsaved != before) changes.push_back({ at, unsaved });
+        }
+        if (!catalog.waitDurable(unsaved)) reply = markUnsaved(reply, changes);
+        if (!reply.empty() && !sendAll(c->fd, reply)) open = false;
+
+        epoll_event ready{};
+        ready.events = EPOLLIN | EPOLLONESHOT;
+        ready.data.ptr = c;
+        if (!open || epoll_ctl(events, EPOLL_CTL_MOD, c->fd, &ready) < 0) {
+            close(c->fd);  // also leaves the epoll set
+            delete c;
+        }
+    }
+
+public:
+    // Restores the catalog saved in `dir` and keeps saving changes there
+    bool openStorage(const string& dir) {
+        storage.reset(new LibraryStorage());
+        if (!storage->open(dir, [this](const LogRecord& r) { catalog.apply(r); })) return false;
+        catalog.attach(storage.get());
+        return true;
+    }
+
+    // Serves until the process is stopped
+    int run(const string& spec, unsigned numThreads) {
+        signal(SIGPIPE, SIG_IGN);
+        int listener = openListener(spec);
+        if (listener < 0) return 1;
+        events = epoll_create1(0);
+        epoll_event listening{};
+        listening.events = EPOLLIN;
+        listening.data.ptr = NULL;  // connections have their Connection here
+        if (events < 0 || epoll_ctl(events, EPOLL_CTL_ADD, listener, &listening) < 0) {
+            cout << "\n✗ Cannot wait for connections: " << strerror(errno) << "\n";
+            close(listener);
+            return 1;
+        }
+        cout << "\n✓ Library server on " << spec << " with " << numThreads << " worker threads" << endl;
+
+        ThreadPool pool(numThreads);
+        epoll_event ready[256];
+        while (true) {
+            int n = epoll_wait(events, ready, 256, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                Connection* c = (Connection*)ready[i].data.ptr;
+                if (c) {
+                    pool.submit([this, c] { serveReady(c); });
+                    continue;
+                }
+                int fd = accept(listener, NULL, NULL);
+                if (fd < 0) continue;
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                if (spec.compare(0, 4, "tcp:") == 0) {
+                    int on = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                }
+                epoll_event request{};
+                request.events = EPOLLIN | EPOLLONESHOT;
+                request.data.ptr = new Connection(fd);
+                if (epoll_ctl(events, EPOLL_CTL_ADD, fd, &request) < 0) {
+                    delete (Connection*)request.data.ptr;
+                    close(fd);
+                }
+            }
+        }
+        close(events);
+        close(listener);
+        return 0;
+    }
+};
+
+/* ================= LOAD GENERATOR ================= */
+// Runs `clients` connections for `seconds`, each sending one request at
+// a time: GET for `readPercent` of them, the rest split between ADD and
+// DEL of books the client added itself and BORROW or RETURN of books in
+// its own share of the preloaded ones (so clients do not queue behind
+// each other's loans). Prints throughput and latency percentiles.
+class LoadGenerator {
+public:
+    static const int PRELOADED_BOOKS = 10000;
+
+private:
+    struct ClientResult {
+        vector<uint32_t> latencyNs;
+        uint64_t errors = 0;
+    };
+
+    static uint64_t nextRandom(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    static bool preload(const string& spec) {
+        int fd = connectTo(spec);
+        if (fd < 0) return false;
+        string batch;
+        for (int id = 1; id <= PRELOADED_BOOKS; id++) {
+            batch += "ADD\t" + to_string(id) + "\tBook " + to_string(id) + "\tAuthor " + to_string(id % 97) +
+                     "\t" + to_string(1900 + id % 125) + "\n";
+        }
+        bool ok = sendAll(fd, batch);
+        LineReader reader(fd);
+        string line;
+        for (int id = 1; ok && id <= PRELOADED_BOOKS; id++) ok = reader.readLine(line);
+        close(fd);
+        return ok;
+    }
+
+    // Book IDs a client may add: the range above the preloaded books split
+    // evenly, so the IDs stay within int for any number of clients
+    static int idStride(int clients) { return (INT_MAX - PRELOADED_BOOKS) / clients; }
+
+    static void runClient(const string& spec, int client, int clients, double seconds, int readPercent,
+                          ClientResult& result) {
+        int fd = connectTo(spec);
+        if (fd < 0) {
+            result.errors++;
+            return;
+        }
+        LineReader reader(fd);
+        uint64_t state = 0x9e3779b97f4a7c15ULL * (client + 1);
+        vector<int> added;
+        int nextId = PRELOADED_BOOKS + 1 + client * idStride(clients);
+        int lastId = nextId + idStride(clients) - 1;  // IDs of other clients follow
+        int share = max(1, PRELOADED_BOOKS / clients);
+        vector<bool> lent(share, false);  // books of the share this client has
+        string request, line;
+        auto deadline = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+
+        while (chrono::steady_clock::now() < deadline) {
+            int pick = (int)(nextRandom(state) % 100);
+            int book = 1 + (int)(nextRandom(state) % PRELOADED_BOOKS);
+            if (pick < readPercent) {
+                request = "GET\t" + to_string(book) + "\n";
+            } else if (pick % 3 == 1 && nextId <= lastId) {
+                added.push_back(nextId);
+                request = "ADD\t" + to_string(nextId++) + "\tLoad test\tGenerator\t2024\n";
+            } else if (pick % 3 == 2 && !added.empty()) {
+                request = "DEL\t" + to_string(added.back()) + "\n";
+                added.pop_back();
+            } else {
+                int slot = (int)(nextRandom(state) % share);
+                int mine = 1 + (client * share + slot) % PRELOADED_BOOKS;
+                if (lent[slot]) request = "RETURN\t" + to_string(mine) + "\n";
+                else request = "BORROW\t" + to_string(client) + "\t" + to_string(mine) + "\n";
+                lent[slot] = !lent[slot];
+            }
+
+            auto begin = chrono::steady_clock::now();
+            if (!sendAll(fd, request) || !reader.readLine(line)) {
+                result.errors++;
+                break;
+            }
+            result.latencyNs.push_back((uint32_t)min<int64_t>(UINT32_MAX,
+                chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count()));
+            if (line.compare(0, 2, "OK") != 0) result.errors++;
+        }
+        // Remove this client's books and loans so the next run starts alike
+        string cleanup;
+        size_t replies = added.size();
+        for (int id : added) cleanup += "DEL\t" + to_string(id) + "\n";
+        for (int slot = 0; slot < share; slot++) {
+            if (!lent[slot]) continue;
+            cleanup += "RETURN\t" + to_string(1 + (client * share + slot) % PRELOADED_BOOKS) + "\n";
+            replies++;
+        }
+        sendAll(fd, cleanup + "QUIT\n");
+        for (size_t i = 0; i < replies && reader.readLine(line); i++) {}
+        close(fd);
+    }
+
+public:
+    static int run(const string& spec, int clients, double seconds, int readPercent) {
+        signal(SIGPIPE, SIG_IGN);
+        if (!preload(spec)) return 1;
+
+        vector<ClientResult> results(clients);
+        vector<thread> threads;
+        auto begin = chrono::steady_clock::now();
+        for (int c = 0; c < clients; c++) {
+            threads.emplace_back(runClient, spec, c, clients, seconds, readPercent, ref(results[c]));
+        }
+        for (thread& t : threads) t.join();
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+        vector<uint32_t> all;
+        uint64_t errors = 0;
+        for (ClientResult& r : results) {
+            all.insert(all.end(), r.latencyNs.begin(), r.latencyNs.end());
+            errors += r.errors;
+        }
+        sort(all.begin(), all.end());
+        auto percentile = [&](double p) {
+            return all.empty() ? 0.0 : all[min(all.size() - 1, (size_t)(p * all.size()))] / 1000.0;
+        };
+
+        cout << "\n" << string(50, '=') << endl;
+        cout << "     📊 LOAD TEST RESULTS\n";
+        cout << string(50, '=') << endl;
+        cout << "   Clients:     " << clients << " (" << readPercent << "% reads)" << endl;
+        cout << "   Requests:    " << all.size() << " in " << elapsed << " s" << endl;
+        cout << "   Throughput:  " << (uint64_t)(all.size() / elapsed) << " requests/s" << endl;
+        cout << "   Latency µs:  p50 " << percentile(0.50) << ", p90 " << percentile(0.90)
+             << ", p99 " << percentile(0.99) << ", p99.9 " << percentile(0.999)
+             << ", max " << (all.empty() ? 0.0 : all.back() / 1000.0) << endl;
+        cout << "   Errors:      " << errors << endl;
+        cout << string(50, '=') << endl;
+        return errors ? 1 : 0;
+    }
+};
+
+#endif
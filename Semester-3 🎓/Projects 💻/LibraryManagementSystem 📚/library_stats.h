@@ -0,0 +1,217 @@
+#ifndef LIBRARY_STATS_H
+#define LIBRARY_STATS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+/*
+ * Running borrow statistics, updated by BorrowHistory::addHistory() so
+ * they never need a walk over the history:
+ *
+ *   CountMinSketch   approximate borrows per book and per user
+ *   TopBooks         the most borrowed books (Space-Saving), each
+ *                    with a HyperLogLog of its distinct readers
+ *   HyperLogLog      approximate number of distinct users overall
+ *
+ * Memory is fixed (about 300 KB) however long the history grows, and each
+ * borrow costs O(1): a few hashed counter updates and at most one swap in
+ * the top-K list.
+ */
+
+inline uint64_t mixHash(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;  // splitmix64
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* ================= COUNT-MIN SKETCH ================= */
+// Never underestimates; overestimates by at most about e / WIDTH of all
+// updates (0.07%) with probability 1 - e^-DEPTH. Updates are conservative:
+// only the rows holding the current minimum are raised.
+class CountMinSketch {
+public:
+    static const int DEPTH = 4;
+    static const int WIDTH = 4096;
+
+private:
+    uint32_t rows[DEPTH][WIDTH];
+
+    // Each row uses its own 16 bits of the hash
+    static uint32_t column(uint64_t h, int row) { return (uint32_t)(h >> (16 * row)) & (WIDTH - 1); }
+
+public:
+    CountMinSketch() { memset(rows, 0, sizeof(rows)); }
+
+    void add(int key) {
+        uint64_t h = mixHash((uint32_t)key);
+        uint32_t* cells[DEPTH];
+        uint32_t smallest = UINT32_MAX;
+        for (int r = 0; r < DEPTH; r++) {
+            cells[r] = &rows[r][column(h, r)];
+            smallest = min(smallest, *cells[r]);
+        }
+        for (int r = 0; r < DEPTH; r++)
+            if (*cells[r] == smallest) (*cells[r])++;
+    }
+
+    uint32_t estimate(int key) const {
+        uint64_t h = mixHash((uint32_t)key);
+        uint32_t smallest = UINT32_MAX;
+        for (int r = 0; r < DEPTH; r++) smallest = min(smallest, rows[r][column(h, r)]);
+        return smallest;
+    }
+};
+
+/* ================= HYPERLOGLOG ================= */
+// Distinct count within about 1.04 / sqrt(REGISTERS): 1.6% for 12 bits
+// (4 KB), 6.5% for 8 bits (256 bytes)
+template <int BITS>
+class HyperLogLog {
+public:
+    static const int REGISTERS = 1 << BITS;
+
+private:
+    uint8_t registers[REGISTERS];
+
+public:
+    HyperLogLog() { clear(); }
+
+    void clear() { memset(registers, 0, sizeof(registers)); }
+
+    void add(int key) {
+        uint64_t h = mixHash((uint32_t)key ^ 0x5bd1e995u);
+        uint32_t index = (uint32_t)(h >> (64 - BITS));
+        uint64_t rest = h << BITS | (1ULL << (BITS - 1));  // stops the count at 64 - BITS + 1
+        uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+        if (rank > registers[index]) registers[index] = rank;
+    }
+
+    double estimate() const {
+        double sum = 0;
+        int zeros = 0;
+        for (int i = 0; i < REGISTERS; i++) {
+            sum += ldexp(1.0, -registers[i]);
+            if (registers[i] == 0) zeros++;
+        }
+        double m = REGISTERS;
+        double raw = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        if (raw <= 2.5 * m && zeros > 0) return m * log(m / zeros);  // small counts: linear counting
+        return raw;
+    }
+};
+
+/* ================= TOP BOOKS ================= */
+// Space-Saving: CAPACITY counters kept in an array sorted by count, most
+// first. A borrow of a tracked book raises its counter; an untracked
+// book takes over the smallest counter and inherits its count (kept as
+// `error`, the most the count may be too high by). Any book with more
+// than 1 / CAPACITY of all borrows is sure to be tracked. Counts only grow
+// by one, so a counter moves up by swapping with the first counter of its
+// equal-count block, and the start of every block is kept in a map.
+class TopBooks {
+public:
+    static const int CAPACITY = 512;
+
+    struct Entry {
+        int bookID;
+        uint64_t count;
+        uint64_t error;
+        int sketch;  // its readers are readerSketches[sketch]
+    };
+
+private:
+    vector<Entry> entries;                    // by count, most first
+    vector<HyperLogLog<8>> readerSketches;    // not moved when entries are swapped
+    unordered_map<int, int> position;         // book -> index in entries
+    unordered_map<uint64_t, int> blockStart;  // count -> first index with it
+
+    // entries[i] gains one borrow
+    int increment(int i) {
+        uint64_t c = entries[i].count;
+        int first = blockStart[c];
+        if (first != i) {
+            swap(entries[first], entries[i]);
+            position[entries[i].bookID] = i;
+            position[entries[first].bookID] = first;
+        }
+        // entries[first] leaves block c and joins the end of block c + 1
+        if (first + 1 < (int)entries.size() && entries[first + 1].count == c) blockStart[c] = first + 1;
+        else blockStart.erase(c);
+        if (!blockStart.count(c + 1)) blockStart[c + 1] = first;
+        entries[first].count++;
+        return first;
+    }
+
+public:
+    TopBooks() : readerSketches(CAPACITY) {
+        entries.reserve(CAPACITY);
+        position.reserve(CAPACITY * 2);
+        blockStart.reserve(CAPACITY * 2);
+    }
+
+    void add(int book, int user) {
+        auto it = position.find(book);
+        int i;
+        if (it != position.end()) {
+            i = increment(it->second);
+        } else if ((int)entries.size() < CAPACITY) {
+            entries.push_back(Entry{ book, 0, 0, (int)entries.size() });
+            i = entries.size() - 1;
+            position[book] = i;
+            if (!blockStart.count(0)) blockStart[0] = i;
+            i = increment(i);
+        } else {
+            i = entries.size() - 1;  // smallest count
+            position.erase(entries[i].bookID);
+            entries[i].bookID = book;
+            entries[i].error = entries[i].count;
+            readerSketches[entries[i].sketch].clear();
+            position[book] = i;
+            i = increment(i);
+        }
+        readerSketches[entries[i].sketch].add(user);
+    }
+
+    // The tracked books by count, most first; the first few are the
+    // reliable ones
+    const vector<Entry>& top() const { return entries; }
+
+    uint64_t distinctReaders(const Entry& e) const {
+        return (uint64_t)llround(readerSketches[e.sketch].estimate());
+    }
+};
+
+/* ================= BORROW STATS ================= */
+class BorrowStats {
+private:
+    uint64_t total = 0;
+    CountMinSketch perBook;
+    CountMinSketch perUser;
+    HyperLogLog<12> users;
+    TopBooks topBooks;
+
+public:
+    void record(int user, int book) {
+        total++;
+        perBook.add(book);
+        perUser.add(user);
+        users.add(user);
+        topBooks.add(book, user);
+    }
+
+    uint64_t totalBorrows() const { return total; }
+    uint32_t bookBorrows(int book) const { return perBook.estimate(book); }
+    uint32_t userBorrows(int user) const { return perUser.estimate(user); }
+    uint64_t distinctUsers() const { return (uint64_t)llround(users.estimate()); }
+    const TopBooks& popularBooks() const { return topBooks; }
+};
+
+#endif
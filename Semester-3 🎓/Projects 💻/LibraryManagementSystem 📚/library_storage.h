@@ -0,0 +1,432 @@
+#ifndef LIBRARY_STORAGE_H
+#define LIBRARY_STORAGE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "library.h"
+#include "library_waitlist.h"
+using namespace std;
+
+/*
+ * Durable storage for the library in a directory of its own:
+ *
+ *   wal-<g>        write-ahead log: every add, delete, borrow and return,
+ *                  appended before the caller reports success
+ *   snapshot-<g>   all books, the borrow history, and the loans and
+ *                  waitlists as of the start of wal-<g>
+ *
+ * Every change is appended to an in-memory buffer under a short lock and
+ * gets a sequence number; waitDurable() then writes and fsyncs the buffer.
+ * Only one thread flushes at a time and it takes everything appended so
+ * far, so concurrent callers share one fsync (group commit) instead of
+ * paying one each. A write or fsync that fails leaves its records
+ * pending: the file is cut back to its last good length, the records are
+ * written again with the next flush, and the callers already waiting on
+ * them learn from waitDurable() that they are not saved yet.
+ *
+ * Once the log holds SNAPSHOT_EVERY records the owner takes a snapshot:
+ * beginSnapshot() (with changes blocked) switches to a new log file, the
+ * state is copied, and writeSnapshot() saves it and deletes the older
+ * files. Recovery loads the newest snapshot and replays only the logs
+ * from its generation on, so restart time stays bounded by the snapshot
+ * size plus SNAPSHOT_EVERY records.
+ *
+ * Records are [length][checksum][payload]. A record cut short by a crash
+ * fails its checksum, ends the replay, and is truncated away. The menu
+ * and the server log loans the same way ('Q' and 'R'), so either can
+ * open a directory the other wrote.
+ */
+
+/* ================= LOG RECORD ================= */
+struct LogRecord {
+    // 'A' add book, 'D' delete book, 'B' borrow (history entry only),
+    // 'Q' request a loan (lent or put on the waitlist), 'R' return,
+    // 'L' loan or hold as saved in a snapshot, 'E' end of snapshot
+    char type;
+    Book book;  // all but 'A' use only book.id
+    int userID;
+
+    static LogRecord add(const Book& b) { return { 'A', b, 0 }; }
+    static LogRecord remove(int id) { return { 'D', Book{ id, "", "", 0 }, 0 }; }
+    static LogRecord borrow(int user, int id) { return { 'B', Book{ id, "", "", 0 }, user }; }
+    static LogRecord request(int user, int id) { return { 'Q', Book{ id, "", "", 0 }, user }; }
+    static LogRecord giveBack(int id) { return { 'R', Book{ id, "", "", 0 }, 0 }; }
+    static LogRecord hold(int user, int id) { return { 'L', Book{ id, "", "", 0 }, user }; }
+
+    bool hasUser() const { return type == 'B' || type == 'Q' || type == 'L'; }
+};
+
+/* ================= LIBRARY STORAGE ================= */
+class LibraryStorage {
+public:
+    static const uint64_t SNAPSHOT_EVERY = 100000;
+
+private:
+    string dir;
+    int walFd = -1;
+    uint64_t generation = 1;
+
+    mutex lock;
+    condition_variable flushed;
+    string pending;             // encoded records not written yet
+    uint64_t nextSequence = 1;  // of the next record appended
+    uint64_t durable = 0;       // records up to this one are on disk
+    uint64_t failed = 0;        // records up to this one were in a failed write
+    off_t logSize = 0;          // bytes of the log that are on disk
+    bool torn = false;          // a failed write may have left bytes past logSize
+    bool flushing = false;
+    uint64_t recordsInLog = 0;
+
+    /* ---------- encoding ---------- */
+    static uint32_t checksum(const char* data, size_t n) {
+        uint32_t h = 2166136261u;  // FNV-1a
+        for (size_t i = 0; i < n; i++) h = (h ^ (uint8_t)data[i]) * 16777619u;
+        return h;
+    }
+
+    static void putInt(string& out, uint32_t x) { out.append((const char*)&x, 4); }
+
+    static void putString(string& out, const string& s) {
+        putInt(out, (uint32_t)s.size());
+        out += s;
+    }
+
+    static void encode(string& out, const LogRecord& r) {
+        string payload(1, r.type);
+        putInt(payload, (uint32_t)r.book.id);
+        if (r.type == 'A') {
+            putInt(payload, (uint32_t)r.book.year);
+            putString(payload, r.book.title);
+            putString(payload, r.book.author);
+        }
+        if (r.hasUser()) putInt(payload, (uint32_t)r.userID);
+        putInt(out, (uint32_t)payload.size());
+        putInt(out, checksum(payload.data(), payload.size()));
+        out += payload;
+    }
+
+    // Reads fields from a payload, failing past its end
+    struct Reader {
+        const char* p;
+        const char* end;
+
+        bool getInt(int& x) {
+            if (end - p < 4) return false;
+            memcpy(&x, p, 4);
+            p += 4;
+            return true;
+        }
+
+        bool getString(string& s) {
+            int n;
+            if (!getInt(n) || n < 0 || end - p < n) return false;
+            s.assign(p, n);
+            p += n;
+            return true;
+        }
+    };
+
+    static bool decode(const char* payload, size_t n, LogRecord& r) {
+        Reader in{ payload + 1, payload + n };
+        if (n == 0) return false;
+        r.type = payload[0];
+        r.book = Book{ 0, "", "", 0 };
+        r.userID = 0;
+        if (!in.getInt(r.book.id)) return false;
+        if (r.type == 'A') return in.getInt(r.book.year) && in.getString(r.book.title) && in.getString(r.book.author);
+        if (r.hasUser()) return in.getInt(r.userID);
+        return r.type == 'D' || r.type == 'R' || r.type == 'E';
+    }
+
+    /* ---------- files ---------- */
+    string fileName(const string& kind, uint64_t g) const { return dir + "/" + kind + "-" + to_string(g); }
+
+    // Generations of the files named "<kind>-<g>", ascending
+    vector<uint64_t> generations(const string& kind) const {
+        vector<uint64_t> found;
+        DIR* d = opendir(dir.c_str());
+        if (!d) return found;
+        string prefix = kind + "-";
+        while (dirent* entry = readdir(d)) {
+            string name = entry->d_name;
+            if (name.compare(0, prefix.size(), prefix) != 0) continue;
+            string digits = name.substr(prefix.size());
+            if (digits.empty() || digits.find_first_not_of("0123456789") != string::npos) continue;
+            found.push_back(stoull(digits));
+        }
+        closedir(d);
+        sort(found.begin(), found.end());
+        return found;
+    }
+
+    // Makes creates, renames and deletes in the directory durable
+    void syncDirectory() const {
+        int fd = ::open(dir.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+    }
+
+    static bool writeAll(int fd, const string& data) {
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = write(fd, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            written += n;
+        }
+        return true;
+    }
+
+    static bool readFile(const string& path, string& data) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        data.clear();
+        char chunk[65536];
+        ssize_t n;
+        while ((n = read(fd, chunk, sizeof(chunk))) > 0) data.append(chunk, n);
+        close(fd);
+        return n == 0;
+    }
+
+    // apply(record) for the valid records of `data`; returns the length
+    // of the valid prefix
+    static size_t replay(const string& data, const function<void(const LogRecord&)>& apply, uint64_t& count) {
+        size_t pos = 0;
+        LogRecord r;
+        while (data.size() - pos >= 8) {
+            uint32_t length, sum;
+            memcpy(&length, &data[pos], 4);
+            memcpy(&sum, &data[pos + 4], 4);
+            if (data.size() - pos - 8 < length) break;
+            const char* payload = &data[pos + 8];
+            if (checksum(payload, length) != sum || !decode(payload, length, r)) break;
+            apply(r);
+            count++;
+            pos += 8 + length;
+        }
+        return pos;
+    }
+
+    void openLog() {
+        walFd = ::open(fileName("wal", generation).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        logSize = walFd >= 0 ? lseek(walFd, 0, SEEK_END) : 0;
+        torn = false;
+        syncDirectory();
+    }
+
+    // Writes out everything appended so far; the lock is released while
+    // writing so others can keep appending. On failure the batch goes back
+    // in front of what was appended meanwhile, to be written again.
+    bool flush(unique_lock<mutex>& guard) {
+        flushing = true;
+        string batch;
+        batch.swap(pending);
+        uint64_t last = nextSequence - 1;
+        int fd = walFd;
+        guard.unlock();
+        bool ok = (!torn || ftruncate(fd, logSize) == 0) && writeAll(fd, batch) && fdatasync(fd) == 0;
+        int error = errno;
+        guard.lock();
+        if (ok) {
+            durable = last;
+            logSize += batch.size();
+            torn = false;
+        } else {
+            cerr << "\n✗ Cannot write the log: " << strerror(error) << "\n";
+            pending.insert(0, batch);
+            failed = last;
+            torn = true;
+        }
+        flushing = false;
+        flushed.notify_all();
+        return ok;
+    }
+
+public:
+    ~LibraryStorage() {
+        if (walFd >= 0) {
+            unique_lock<mutex> guard(lock);
+            while (flushing) flushed.wait(guard);
+            if (!pending.empty()) flush(guard);
+            close(walFd);
+        }
+    }
+
+    // Creates `directory` if needed and replays what it holds through
+    // apply(): the newest snapshot first, then the logs after it.
+    bool open(const string& directory, const function<void(const LogRecord&)>& apply) {
+        dir = directory;
+        mkdir(dir.c_str(), 0755);
+
+        // A snapshot is complete only if it ends in its 'E' record
+        uint64_t base = 0, loaded = 0;
+        vector<uint64_t> snapshots = generations("snapshot");
+        string data;
+        for (auto g = snapshots.rbegin(); g != snapshots.rend(); ++g) {
+            uint64_t count = 0;
+            bool complete = false;
+            vector<LogRecord> records;
+            if (!readFile(fileName("snapshot", *g), data)) continue;
+            replay(data, [&](const LogRecord& r) {
+                if (r.type == 'E') complete = true;
+                else records.push_back(r);
+            }, count);
+            if (!complete) continue;
+            for (const LogRecord& r : records) apply(r);
+            base = *g;
+            loaded = records.size();
+            break;
+        }
+
+        uint64_t replayed = 0;
+        generation = max<uint64_t>(base, 1);
+        for (uint64_t g : generations("wal")) {
+            if (g < base) continue;
+            generation = g;
+            string path = fileName("wal", g);
+            if (!readFile(path, data)) return false;
+            recordsInLog = 0;
+            size_t valid = replay(data, apply, recordsInLog);
+            replayed += recordsInLog;
+            if (valid < data.size() && truncate(path.c_str(), valid) != 0) return false;
+        }
+        openLog();
+        if (walFd < 0) {
+            cout << "\n✗ Cannot open the log in " << dir << ": " << strerror(errno) << "\n";
+            return false;
+        }
+        cout << "\n✓ Restored " << loaded << " record(s) from the snapshot and "
+             << replayed << " from the log.\n";
+        return true;
+    }
+
+    // Queues a change; returns its sequence number for waitDurable()
+    uint64_t append(const LogRecord& r) {
+        lock_guard<mutex> guard(lock);
+        encode(pending, r);
+        recordsInLog++;
+        return nextSequence++;
+    }
+
+    // Returns once record `sequence` is on disk, writing it if no other
+    // thread is already doing so; false if the write failed
+    bool waitDurable(uint64_t sequence) {
+        unique_lock<mutex> guard(lock);
+        while (durable < sequence) {
+            if (failed >= sequence) return false;
+            if (flushing) flushed.wait(guard);
+            else flush(guard);
+        }
+        return true;
+    }
+
+    bool isDurable(uint64_t sequence) {
+        lock_guard<mutex> guard(lock);
+        return durable >= sequence;
+    }
+
+    bool snapshotDue() {
+        lock_guard<mutex> guard(lock);
+        return recordsInLog >= SNAPSHOT_EVERY;
+    }
+
+    // Flushes the current log and starts the next one. Call with changes
+    // blocked, copy the state, then pass it to writeSnapshot() with the
+    // generation returned here. Records the old log could not take are
+    // left to the snapshot, which holds their changes anyway.
+    uint64_t beginSnapshot() {
+        unique_lock<mutex> guard(lock);
+        while (flushing) flushed.wait(guard);
+        if (!pending.empty() && !flush(guard)) {
+            pending.clear();
+            failed = nextSequence - 1;
+        }
+        close(walFd);
+        generation++;
+        recordsInLog = 0;
+        openLog();
+        return generation;
+    }
+
+    // Saves `state` (books, then history oldest first) as the snapshot
+    // for `g` and drops the snapshots and logs it replaces
+    bool writeSnapshot(uint64_t g, const vector<LogRecord>& state) {
+        string data;
+        for (const LogRecord& r : state) encode(data, r);
+        encode(data, LogRecord{ 'E', Book{ 0, "", "", 0 }, 0 });
+        string path = fileName("snapshot", g);
+        int fd = ::open((path + ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        bool ok = writeAll(fd, data) && fsync(fd) == 0;
+        close(fd);
+        if (!ok || rename((path + ".tmp").c_str(), path.c_str()) != 0) return false;
+        syncDirectory();
+        for (uint64_t old : generations("snapshot"))
+            if (old < g) unlink(fileName("snapshot", old).c_str());
+        for (uint64_t old : generations("wal"))
+            if (old < g) unlink(fileName("wal", old).c_str());
+        return true;
+    }
+};
+
+/* ================= LOANS ================= */
+// Shared by the menu, the server and log replay: a loan granted (at once
+// or on a return) is what goes into the history
+inline int requestLoan(Waitlists& holds, BorrowHistory& history, int user, int book) {
+    int result = holds.request(user, book);
+    if (result == Waitlists::LENT) history.addHistory(user, book);
+    return result;
+}
+
+inline bool returnLoan(Waitlists& holds, BorrowHistory& history, int book, int& next) {
+    if (!holds.returnBook(book, next)) return false;
+    if (next != Waitlists::NONE) history.addHistory(next, book);
+    return true;
+}
+
+// The part of a replayed record that concerns loans and the history;
+// books themselves are left to the caller
+inline void replayLoans(const LogRecord& r, Waitlists& holds, BorrowHistory& history) {
+    int next;
+    if (r.type == 'D') holds.removeBook(r.book.id);
+    else if (r.type == 'B') history.addHistory(r.userID, r.book.id);
+    else if (r.type == 'Q') requestLoan(holds, history, r.userID, r.book.id);
+    else if (r.type == 'R') returnLoan(holds, history, r.book.id, next);
+    else if (r.type == 'L') holds.request(r.userID, r.book.id);
+}
+
+// Snapshot records of every loan followed by its holds in waitlist order
+inline void appendHolds(vector<LogRecord>& state, Waitlists& holds) {
+    holds.forEach([&](int book, int holder, const vector<int>& waiting) {
+        state.push_back(LogRecord::hold(holder, book));
+        for (int user : waiting) state.push_back(LogRecord::hold(user, book));
+    });
+}
+
+// The state of the menu's library as snapshot records: books, history,
+// then every loan followed by its holds in waitlist order
+inline vector<LogRecord> snapshotOf(BookArray& library, BorrowHistory& history, Waitlists& holds) {
+    vector<LogRecord> state;
+    for (int i = 0; i < library.getSize(); i++) state.push_back(LogRecord::add(library.get(i)));
+    size_t books = state.size();
+    history.forEach([&](int user, int book) { state.push_back(LogRecord::borrow(user, book)); });
+    reverse(state.begin() + books, state.end());  // history is kept newest first
+    appendHolds(state, holds);
+    return state;
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef LIBRARY_WAITLIST_H
+#define LIBRARY_WAITLIST_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+using namespace std;
+
+/*
+ * Loans and holds per book. A book is either available or lent to one
+ * user; requests for a lent book join that book's waitlist, and when the
+ * book comes back it goes straight to the first user waiting.
+ *
+ * Each waitlist is a singly linked FIFO with head and tail, so joining
+ * and promoting are O(1). Its nodes come from a HoldPool: slabs of
+ * 4096 nodes linked by 32-bit indices, with freed nodes reused first.
+ * So there is no allocation per request, and memory stops growing at
+ * maxHolds nodes (8 bytes each).
+ */
+
+/* ================= HOLD POOL ================= */
+class HoldPool {
+public:
+    static const uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        int userID;
+        uint32_t next;
+    };
+
+private:
+    static const uint32_t SLAB = 4096;
+
+    vector<unique_ptr<Node[]>> slabs;
+    uint32_t freeList = NIL;  // released nodes, linked through next
+    uint32_t carved = 0;      // nodes handed out from the slabs so far
+    uint32_t live = 0;
+    uint32_t limit;
+
+public:
+    HoldPool(uint32_t maxHolds) : limit(maxHolds) {}
+
+    Node& at(uint32_t i) { return slabs[i / SLAB][i % SLAB]; }
+
+    // A node for `user`, or NIL once maxHolds are in use
+    uint32_t allocate(int user) {
+        uint32_t i;
+        if (freeList != NIL) {
+            i = freeList;
+            freeList = at(i).next;
+        } else {
+            if (carved == limit) return NIL;
+            if (carved % SLAB == 0) slabs.emplace_back(new Node[SLAB]);
+            i = carved++;
+        }
+        at(i) = Node{ user, NIL };
+        live++;
+        return i;
+    }
+
+    void release(uint32_t i) {
+        at(i).next = freeList;
+        freeList = i;
+        live--;
+    }
+
+    uint32_t inUse() const { return live; }
+    size_t bytes() const { return slabs.size() * SLAB * sizeof(Node); }
+};
+
+/* ================= WAITLISTS ================= */
+class Waitlists {
+public:
+    static const int NONE = INT_MIN;  // no user
+
+    // Results of request(); positions on the waitlist are 1, 2, ...
+    static const int LENT = 0;
+    static const int ALREADY_LENT = -1;  // the user has the book already
+    static const int FULL = -2;          // no room for more holds
+
+private:
+    struct Book {
+        int holder = NONE;
+        uint32_t head = HoldPool::NIL;
+        uint32_t tail = HoldPool::NIL;
+        uint32_t waiting = 0;
+    };
+
+    HoldPool pool;
+    unordered_map<int, Book> books;  // only books lent out
+
+public:
+    Waitlists(uint32_t maxHolds = 1u << 24) : pool(maxHolds) {}
+
+    // Lends the book to `user` if it is available, otherwise puts them at
+    // the end of its waitlist. Returns LENT, the position, or an error.
+    int request(int user, int bookID) {
+        Book& b = books[bookID];
+        if (b.holder == NONE) {
+            b.holder = user;
+            return LENT;
+        }
+        if (b.holder == user) return ALREADY_LENT;
+        uint32_t node = pool.allocate(user);
+        if (node == HoldPool::NIL) return FULL;
+        if (b.tail == HoldPool::NIL) b.head = node;
+        else pool.at(b.tail).next = node;
+        b.tail = node;
+        return ++b.waiting;
+    }
+
+    // Takes the book back and lends it to the first user waiting, who is
+    // returned in `next` (NONE if the book is now available). False if the
+    // book was not lent out.
+    bool returnBook(int bookID, int& next) {
+        auto it = books.find(bookID);
+        if (it == books.end()) return false;
+        Book& b = it->second;
+        if (b.head == HoldPool::NIL) {
+            next = NONE;
+            books.erase(it);
+            return true;
+        }
+        uint32_t node = b.head;
+        next = b.holder = pool.at(node).userID;
+        b.head = pool.at(node).next;
+        if (b.head == HoldPool::NIL) b.tail = HoldPool::NIL;
+        b.waiting--;
+        pool.release(node);
+        return true;
+    }
+
+    // Drops the loan and every hold of a deleted book
+    void removeBook(int bookID) {
+        auto it = books.find(bookID);
+        if (it == books.end()) return;
+        for (uint32_t node = it->second.head; node != HoldPool::NIL;) {
+            uint32_t next = pool.at(node).next;
+            pool.release(node);
+            node = next;
+        }
+        books.erase(it);
+    }
+
+    int holder(int bookID) const {
+        auto it = books.find(bookID);
+        return it == books.end() ? NONE : it->second.holder;
+    }
+
+    uint32_t waiting(int bookID) const {
+        auto it = books.find(bookID);
+        return it == books.end() ? 0 : it->second.waiting;
+    }
+
+    // Where `user` is on the book's waitlist, 0 if not on it. A walk over
+    // the list, so request() leaves it to the caller.
+    uint32_t position(int user, int bookID) {
+        auto it = books.find(bookID);
+        if (it == books.end()) return 0;
+        uint32_t k = 1;
+        for (uint32_t node = it->second.head; node != HoldPool::NIL; node = pool.at(node).next, k++)
+            if (pool.at(node).userID == user) return k;
+        return 0;
+    }
+
+    uint32_t totalHolds() { return pool.inUse(); }
+    size_t poolBytes() const { return pool.bytes(); }
+
+    // f(bookID, holder, waiting users in order) for every book lent out
+    template <class F>
+    void forEach(F f) {
+        vector<int> queue;
+        for (auto& entry : books) {
+            queue.clear();
+            for (uint32_t node = entry.second.head; node != HoldPool::NIL; node = pool.at(node).next)
+                queue.push_back(pool.at(node).userID);
+            f(entry.first, entry.second.holder, queue);
+        }
+    }
+};
+
+/* ================= BENCHMARK ================= */
+// Places `numHolds` holds spread over `numBooks` lent books, then
+// returns every book until all the waitlists are empty
+inline int runHoldsBenchmark(uint32_t numHolds, int numBooks) {
+    Waitlists lists(numHolds);
+    for (int b = 0; b < numBooks; b++) lists.request(-1, b);  // lend every book first
+
+    auto begin = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < numHolds; i++) lists.request((int)i, (int)(i % numBooks));
+    double holdSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    uint32_t peak = lists.totalHolds();
+    size_t bytes = lists.poolBytes();
+
+    begin = chrono::steady_clock::now();
+    uint64_t promotions = 0;
+    int next;
+    for (bool any = true; any;) {
+        any = false;
+        for (int b = 0; b < numBooks; b++) {
+            if (lists.returnBook(b, next) && next != Waitlists::NONE) {
+                promotions++;
+                any = true;
+            }
+        }
+    }
+    double returnSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    cout << "\n" << string(50, '=') << endl;
+    cout << "     ⏳ WAITLIST BENCHMARK\n";
+    cout << string(50, '=') << endl;
+    cout << "   Holds:       " << peak << " on " << numBooks << " books" << endl;
+    cout << "   Pool:        " << bytes / (1024 * 1024) << " MB" << endl;
+    cout << "   Hold:        " << holdSeconds * 1e9 / numHolds << " ns each" << endl;
+    cout << "   Promotion:   " << returnSeconds * 1e9 / max<uint64_t>(1, promotions) << " ns each ("
+         << promotions << ")" << endl;
+    cout << string(50, '=') << endl;
+    return 0;
+}
+
+#endif
@@ -1,200 +1,107 @@
 #include <iostream>
 #include <string>
+#include "library.h"
+#include "library_waitlist.h"
+#include "library_storage.h"
+#include "library_server.h"
+#include "library_analytics.h"
+#include "library_query.h"
 using namespace std;
 
-/* ================= BOOK STRUCT ================= */
-struct Book {
-    int id;
-    string title;
-    string author;
-    int year;
-};
-
-/* ================= ARRAY ADT ================= */
-class BookArray {
-private:
-    Book* arr;
-    int size;
-    int capacity;
-
-public:
-    BookArray(int cap = 50) {
-        capacity = cap;
-        size = 0;
-        arr = new Book[capacity];
+/* ================= COMMAND LINE MODES ================= */
+// library [--data DIR] --serve unix:/tmp/library.sock [threads]
+// library --load unix:/tmp/library.sock [clients] [seconds] [readPercent]
+// library --coborrow-bench EVENTS [threads]
+// library --query-bench BOOKS [threads]
+// library --holds-bench HOLDS [books]
+int runCommandMode(int argc, char** argv, const string& dataDir) {
+    string mode = argv[1];
+    if (mode == "--serve" && argc >= 3) {
+        unsigned threads = argc > 3 ? atoi(argv[3]) : max(1u, thread::hardware_concurrency());
+        LibraryServer server;
+        if (!dataDir.empty() && !server.openStorage(dataDir)) return 1;
+        return server.run(argv[2], threads);
     }
-
-    int getSize() { return size; }
-
-    Book& get(int i) { return arr[i]; }
-
-    void addBook(Book b) {
-        if (size < capacity) {
-            arr[size++] = b;
-            cout << "\n✓ Book added successfully!\n";
-        }
-        else {
-            cout << "\n✗ Library full!\n";
+    if (mode == "--load" && argc >= 3) {
+        int clients = argc > 3 ? atoi(argv[3]) : 8;
+        double seconds = argc > 4 ? atof(argv[4]) : 5;
+        int readPercent = argc > 5 ? atoi(argv[5]) : 90;
+        if (clients < 1 || seconds <= 0 || readPercent < 0 || readPercent > 100) {
+            cout << "\n✗ Bad load test settings.\n";
+            return 1;
         }
+        return LoadGenerator::run(argv[2], clients, seconds, readPercent);
     }
-
-    void deleteBook(int id) {
-        for (int i = 0; i < size; i++) {
-            if (arr[i].id == id) {
-                for (int j = i; j < size - 1; j++)
-                    arr[j] = arr[j + 1];
-                size--;
-                cout << "\n✓ Book deleted successfully!\n";
-                return;
-            }
-        }
-        cout << "\n✗ Book not found!\n";
+    if (mode == "--coborrow-bench" && argc >= 3) {
+        unsigned threads = argc > 3 ? atoi(argv[3]) : max(1u, thread::hardware_concurrency());
+        return runCoBorrowBenchmark(strtoull(argv[2], NULL, 10), max(1u, threads));
     }
-
-    int searchBook(int id) {
-        for (int i = 0; i < size; i++)
-            if (arr[i].id == id)
-                return i;
-        return -1;
+    if (mode == "--query-bench" && argc >= 3) {
+        unsigned threads = argc > 3 ? atoi(argv[3]) : max(1u, thread::hardware_concurrency());
+        return runQueryBenchmark(strtoull(argv[2], NULL, 10), max(1u, threads));
     }
-
-    void displayBooks() {
-        if (size == 0) {
-            cout << "\n📚 No books available.\n";
-            return;
+    if (mode == "--holds-bench" && argc >= 3) {
+        int books = argc > 3 ? atoi(argv[3]) : 1000;
+        uint32_t holds = (uint32_t)strtoul(argv[2], NULL, 10);
+        if (books < 1 || holds < 1) {
+            cout << "\n✗ Bad benchmark settings.\n";
+            return 1;
         }
-        cout << "\n" << string(70, '=') << endl;
-        cout << "                      📚 LIBRARY COLLECTION\n";
-        cout << string(70, '=') << endl;
-        for (int i = 0; i < size; i++) {
-            cout << "\n📖 Book #" << (i + 1) << "\n";
-            cout << "   ID:     " << arr[i].id << endl;
-            cout << "   Title:  " << arr[i].title << endl;
-            cout << "   Author: " << arr[i].author << endl;
-            cout << "   Year:   " << arr[i].year << endl;
-            cout << "   " << string(50, '-') << endl;
-        }
-    }
-};
-
-/* ================= MERGE SORT ================= */
-void merge(Book arr[], int l, int m, int r) {
-    int n1 = m - l + 1;
-    int n2 = r - m;
-
-    Book* L = new Book[n1];
-    Book* R = new Book[n2];
-
-    for (int i = 0; i < n1; i++) L[i] = arr[l + i];
-    for (int j = 0; j < n2; j++) R[j] = arr[m + 1 + j];
-
-    int i = 0, j = 0, k = l;
-
-    while (i < n1 && j < n2) {
-        if (L[i].year <= R[j].year)
-            arr[k++] = L[i++];
-        else
-            arr[k++] = R[j++];
+        return runHoldsBenchmark(holds, books);
     }
-
-    while (i < n1) arr[k++] = L[i++];
-    while (j < n2) arr[k++] = R[j++];
-
-    delete[] L;
-    delete[] R;
+    cout << "Usage: " << argv[0] << " [--data DIR] [--serve unix:PATH|tcp:PORT [threads]]\n"
+         << "       " << argv[0] << " [--load unix:PATH|tcp:PORT [clients] [seconds] [readPercent]]\n"
+         << "       " << argv[0] << " [--coborrow-bench EVENTS [threads]]\n"
+         << "       " << argv[0] << " [--query-bench BOOKS [threads]]\n"
+         << "       " << argv[0] << " [--holds-bench HOLDS [books]]\n";
+    return 1;
 }
 
-void mergeSort(Book arr[], int l, int r) {
-    if (l < r) {
-        int m = (l + r) / 2;
-        mergeSort(arr, l, m);
-        mergeSort(arr, m + 1, r);
-        merge(arr, l, m, r);
-    }
-}
-
-/* ================= QUEUE (BORROW) ================= */
-struct QueueNode {
-    int bookID;
-    QueueNode* next;
-};
-
-class BorrowQueue {
-private:
-    QueueNode* front;
-    QueueNode* rear;
-
-public:
-    BorrowQueue() {
-        front = rear = NULL;
-    }
-
-    void borrowBook(int id) {
-        QueueNode* node = new QueueNode{ id, NULL };
-        if (!rear)
-            front = rear = node;
-        else {
-            rear->next = node;
-            rear = node;
-        }
-        cout << "\n✓ Borrow request added to queue.\n";
-    }
-
-    int processBorrow() {
-        if (!front) return -1;
-        int id = front->bookID;
-        QueueNode* temp = front;
-        front = front->next;
-        delete temp;
-        return id;
-    }
-};
-
-/* ================= LINKED LIST (HISTORY) ================= */
-struct HistoryNode {
-    int userID;
-    int bookID;
-    HistoryNode* next;
-};
-
-class BorrowHistory {
-private:
-    HistoryNode* head;
-
-public:
-    BorrowHistory() {
-        head = NULL;
+/* ================= PERSISTENCE ================= */
+// Logs a change made in the menu and waits until it is on disk; takes a
+// snapshot once the log has grown long enough
+void persist(LibraryStorage* storage, const LogRecord& r, BookArray& library, BorrowHistory& history,
+             Waitlists& holds) {
+    if (!storage) return;
+    if (!storage->waitDurable(storage->append(r))) {
+        cout << "\n✗ Save failed: the change is only in memory for now.\n";
+        return;
     }
-
-    void addHistory(int user, int book) {
-        HistoryNode* node = new HistoryNode{ user, book, head };
-        head = node;
+    if (storage->snapshotDue()) {
+        uint64_t g = storage->beginSnapshot();
+        if (!storage->writeSnapshot(g, snapshotOf(library, history, holds)))
+            cout << "\n✗ Snapshot failed.\n";
     }
+}
 
-    void displayHistory() {
-        if (!head) {
-            cout << "\n📜 No borrowing history.\n";
-            return;
-        }
-        cout << "\n" << string(70, '=') << endl;
-        cout << "                   📜 BORROWING HISTORY\n";
-        cout << string(70, '=') << endl;
-        HistoryNode* temp = head;
-        int count = 1;
-        while (temp) {
-            cout << count++ << ". 👤 User " << temp->userID
-                << " borrowed 📖 Book ID " << temp->bookID << endl;
-            temp = temp->next;
-        }
-        cout << string(70, '=') << endl;
+/* ================= MAIN MENU ================= */
+int main(int argc, char** argv) {
+    // --data DIR keeps the library in DIR between runs
+    string dataDir;
+    if (argc > 2 && string(argv[1]) == "--data") {
+        dataDir = argv[2];
+        argv[2] = argv[0];  // drop the option, keep the program name first
+        argc -= 2;
+        argv += 2;
     }
-};
+    if (argc > 1) return runCommandMode(argc, argv, dataDir);
 
-/* ================= MAIN MENU ================= */
-int main() {
     BookArray library;
-    BorrowQueue queue;
+    Waitlists holds;
     BorrowHistory history;
+    CoBorrowTable coBorrow;                 // built on first use
+    uint64_t coBorrowBuiltAt = UINT64_MAX;  // history size it was built from
+
+    unique_ptr<LibraryStorage> storage;
+    if (!dataDir.empty()) {
+        storage.reset(new LibraryStorage());
+        bool opened = storage->open(dataDir, [&](const LogRecord& r) {
+            if (r.type == 'A') library.insertBook(r.book);
+            else if (r.type == 'D') library.removeBook(r.book.id);
+            replayLoans(r, holds, history);
+        });
+        if (!opened) return 1;
+    }
 
     int choice;
 
@@ -206,11 +113,17 @@ int main() {
         cout << "     1. ➕ Add Book\n";
         cout << "     2. ❌ Delete Book\n";
         cout << "     3. 📋 Display All Books\n";
-        cout << "     4. 🔄 Sort Books by Year\n";
+        cout << "     4. 🔄 Display Books by Year\n";
         cout << "     5. 🔍 Search Book by ID\n";
         cout << "\n  📚 Borrowing:\n";
         cout << "     6. 📤 Borrow Book\n";
         cout << "     7. 📜 View Borrow History\n";
+        cout << "    12. 📥 Return Book\n";
+        cout << "\n  📊 Reports:\n";
+        cout << "     8. 📅 Books by Year Range\n";
+        cout << "     9. 🤝 Readers Also Borrowed\n";
+        cout << "    10. 📈 Borrowing Statistics\n";
+        cout << "    11. 🧮 Catalog Report\n";
         cout << "\n     0. 🚪 Exit\n";
         cout << string(50, '=') << endl;
         cout << "\n➤ Enter your choice: ";
@@ -225,7 +138,8 @@ int main() {
             cout << "Enter Title: "; getline(cin, b.title);
             cout << "Enter Author: "; getline(cin, b.author);
             cout << "Enter Year: "; cin >> b.year;
-            library.addBook(b);
+            if (library.addBook(b))
+                persist(storage.get(), LogRecord::add(b), library, history, holds);
         }
         else if (choice == 2) {
             int id;
@@ -233,18 +147,16 @@ int main() {
             cout << string(30, '-') << endl;
             cout << "Enter Book ID to delete: ";
             cin >> id;
-            library.deleteBook(id);
+            if (library.deleteBook(id)) {
+                holds.removeBook(id);
+                persist(storage.get(), LogRecord::remove(id), library, history, holds);
+            }
         }
         else if (choice == 3) {
             library.displayBooks();
         }
         else if (choice == 4) {
-            if (library.getSize() > 0) {
-                mergeSort(&library.get(0), 0, library.getSize() - 1);
-                cout << "\n✓ Books sorted by year successfully!\n";
-            } else {
-                cout << "\n✗ No books to sort!\n";
-            }
+            library.displayByYear();
         }
         else if (choice == 5) {
             int id;
@@ -271,14 +183,119 @@ int main() {
             cout << "Enter Book ID: ";
             cin >> bookID;
 
-            queue.borrowBook(bookID);
-            int processed = queue.processBorrow();
-            history.addHistory(userID, processed);
-            cout << "✓ Book borrowed successfully!\n";
+            if (library.searchBook(bookID) == -1) {
+                cout << "\n✗ Book not found.\n";
+            }
+            else if (uint32_t k = holds.position(userID, bookID)) {
+                cout << "\n✗ You are already #" << k << " on its waitlist.\n";
+            }
+            else {
+                int result = requestLoan(holds, history, userID, bookID);
+                if (result == Waitlists::LENT)
+                    cout << "\n✓ Book borrowed successfully!\n";
+                else if (result == Waitlists::ALREADY_LENT)
+                    cout << "\n✗ You already have this book.\n";
+                else if (result == Waitlists::FULL)
+                    cout << "\n✗ Waitlist is full, try again later.\n";
+                else
+                    cout << "\n⏳ Book is on loan. You are #" << result << " on its waitlist.\n";
+                if (result == Waitlists::LENT || result > 0)
+                    persist(storage.get(), LogRecord::request(userID, bookID), library, history, holds);
+            }
         }
         else if (choice == 7) {
             history.displayHistory();
         }
+        else if (choice == 8) {
+            int from, to;
+            cout << "\n📅 BOOKS BY YEAR RANGE\n";
+            cout << string(30, '-') << endl;
+            cout << "From year: ";
+            cin >> from;
+            cout << "To year: ";
+            cin >> to;
+            library.displayByYear(from, to);
+        }
+        else if (choice == 9) {
+            int id;
+            cout << "\n🤝 READERS ALSO BORROWED\n";
+            cout << string(30, '-') << endl;
+            cout << "Enter Book ID: ";
+            cin >> id;
+            // Rebuilt only when a borrow has been added since
+            if (coBorrowBuiltAt != history.statistics().totalBorrows()) {
+                coBorrow.build(history);
+                coBorrowBuiltAt = history.statistics().totalBorrows();
+            }
+            const CoBorrowTable::Related* list;
+            int n = coBorrow.related(id, list);
+            if (n == 0)
+                cout << "\n📜 No other books borrowed by readers of this book.\n";
+            for (int i = 0; i < n; i++) {
+                int index = library.searchBook(list[i].bookID);
+                cout << (i + 1) << ". 📖 Book ID " << list[i].bookID;
+                if (index != -1) cout << " (" << library.get(index).title << ")";
+                cout << " - " << list[i].readers << " reader(s)" << endl;
+            }
+        }
+        else if (choice == 10) {
+            const BorrowStats& stats = history.statistics();
+            cout << "\n" << string(70, '=') << endl;
+            cout << "                   📈 BORROWING STATISTICS\n";
+            cout << string(70, '=') << endl;
+            cout << "   Total borrows:  " << stats.totalBorrows() << endl;
+            cout << "   Readers:        ~" << stats.distinctUsers() << endl;
+            const vector<TopBooks::Entry>& top = stats.popularBooks().top();
+            if (!top.empty()) cout << "\n   🏆 Most borrowed:\n";
+            for (size_t i = 0; i < top.size() && i < 10; i++) {
+                int index = library.searchBook(top[i].bookID);
+                cout << "   " << (i + 1) << ". 📖 Book ID " << top[i].bookID;
+                if (index != -1) cout << " (" << library.get(index).title << ")";
+                cout << " - " << top[i].count << " borrow(s)";
+                if (top[i].error > 0) cout << " (at least " << top[i].count - top[i].error << ")";
+                cout << ", ~" << stats.popularBooks().distinctReaders(top[i]) << " reader(s)" << endl;
+            }
+            cout << string(70, '=') << endl;
+        }
+        else if (choice == 11) {
+            CatalogQuery q;
+            int group;
+            cout << "\n🧮 CATALOG REPORT\n";
+            cout << string(30, '-') << endl;
+            cin.ignore();
+            cout << "Author (blank for all): "; getline(cin, q.author);
+            cout << "From year: "; cin >> q.minYear;
+            cout << "To year: "; cin >> q.maxYear;
+            cout << "Group by (0 = none, 1 = decade, 2 = author): "; cin >> group;
+            if (group == 1) q.groupBy = CatalogQuery::DECADE;
+            if (group == 2) q.groupBy = CatalogQuery::AUTHOR;
+
+            ColumnarCatalog columns;
+            columns.build(library);
+            QueryResult result = columns.run(q);
+            cout << "\n✓ " << result.matched << " book(s) match.\n";
+            for (auto& g : result.groups)
+                cout << "   " << g.first << ": " << g.second << endl;
+        }
+
+        else if (choice == 12) {
+            int bookID, next;
+            cout << "\n📥 RETURN BOOK\n";
+            cout << string(30, '-') << endl;
+            cout << "Enter Book ID: ";
+            cin >> bookID;
+            if (!returnLoan(holds, history, bookID, next)) {
+                cout << "\n✗ Book is not on loan.\n";
+            }
+            else {
+                persist(storage.get(), LogRecord::giveBack(bookID), library, history, holds);
+                if (next == Waitlists::NONE)
+                    cout << "\n✓ Book returned and available again.\n";
+                else
+                    cout << "\n✓ Book returned and lent to 👤 User " << next << " from the waitlist ("
+                         << holds.waiting(bookID) << " still waiting).\n";
+            }
+        }
 
     } while (choice != 0);
 